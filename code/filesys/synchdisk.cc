@@ -84,6 +84,31 @@ SynchDisk::WriteSector(int sectorNumber, char* data)
     lock->Release();
 }
 
+//----------------------------------------------------------------------
+// SynchDisk::ReadSectors/WriteSectors
+// 	Like ReadSector/WriteSector, but transfer "numSectors" consecutive
+//	sectors, which must all be on the same track, in one disk request.
+//	This saves the seek and rotational delay for all but the first.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::ReadSectors(int sectorNumber, int numSectors, char* data)
+{
+    lock->Acquire();			// only one disk I/O at a time
+    disk->ReadRequest(sectorNumber, data, numSectors);
+    semaphore->P();			// wait for interrupt
+    lock->Release();
+}
+
+void
+SynchDisk::WriteSectors(int sectorNumber, int numSectors, char* data)
+{
+    lock->Acquire();			// only one disk I/O at a time
+    disk->WriteRequest(sectorNumber, data, numSectors);
+    semaphore->P();			// wait for interrupt
+    lock->Release();
+}
+
 //----------------------------------------------------------------------
 // SynchDisk::CallBack
 // 	Disk interrupt handler.  Wake up any thread waiting for the disk
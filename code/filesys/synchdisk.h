@@ -41,12 +41,15 @@ public:
     // then wait until the request is done.
     void WriteSector(int sectorNumber, char *data);
 
+    void ReadSectors(int sectorNumber, int numSectors, char *data);
+    void WriteSectors(int sectorNumber, int numSectors, char *data);
+    // Read/write a run of consecutive sectors
+    // on one track, in a single request.
+
     void CallBack(); // Called by the disk device interrupt
                      // handler, to signal that the
                      // current disk operation is complete.
 
-    int numUsedSectors  = 0; // Number of sectors used
-
 private:
     Disk *disk;           // Raw disk device
     Semaphore *semaphore; // To synchronize requesting thread
@@ -28,6 +28,7 @@ const char dbgDisk = 'd'; 		// disk emulation (FILESYS)
 const char dbgFile = 'f'; 		// file system (FILESYS)
 const char dbgAddr = 'a'; 		// address spaces (USER_PROGRAM)
 const char dbgNet = 'n'; 		// network emulation (NETWORK)
+const char dbgPaging = 'p';		// paging and working sets (USER_PROGRAM)
 
 class Debug {
   public:
@@ -0,0 +1,332 @@
+// heap.cc
+//	Routines to manage a binary heap of "things".  Heaps are
+//	implemented as templates so that we can store anything in
+//	the heap in a type-safe manner.
+//
+//	The heap grows by doubling the array, so unlike a List no
+//	memory is allocated for each item put in it.
+//
+//	NOTE: Mutual exclusion must be provided by the caller.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+
+const int InitialHeapSize = 16;
+
+//----------------------------------------------------------------------
+// Heap<T>::Heap
+//	Initialize a heap, empty to start with.
+//
+//	"comp" is the function used to order the items.
+//	"index", if not NULL, returns where an item keeps its slot.
+//----------------------------------------------------------------------
+
+template <class T>
+Heap<T>::Heap(int (*comp)(T x, T y), int *(*index)(T x))
+{
+    compare = comp;
+    indexOf = index;
+    size = InitialHeapSize;
+    heap = new HeapElement<T>[size];
+    numInHeap = 0;
+    nextOrder = 0;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::~Heap
+//	Prepare a heap for deallocation.
+//----------------------------------------------------------------------
+
+template <class T>
+Heap<T>::~Heap()
+{
+    ASSERT(IsEmpty());		// make sure heap is empty
+    delete [] heap;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Insert
+//	Put an item in the heap, growing the array if it is full.
+//
+//	"item" is the thing to put in the heap.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Insert(T item)
+{
+    ASSERT(indexOf != NULL ? *indexOf(item) < 0 : !IsInHeap(item));
+    if (numInHeap == size) {
+	HeapElement<T> *bigger = new HeapElement<T>[size * 2];
+
+	for (int i = 0; i < numInHeap; i++)
+	    bigger[i] = heap[i];
+	delete [] heap;
+	heap = bigger;
+	size *= 2;
+    }
+    heap[numInHeap].item = item;
+    heap[numInHeap].order = nextOrder++;
+    SetIndex(numInHeap);
+    numInHeap++;
+    SiftUp(numInHeap - 1);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::RemoveFront
+//	Remove the smallest item from the heap.
+//
+//	Returns the removed item.
+//----------------------------------------------------------------------
+
+template <class T>
+T
+Heap<T>::RemoveFront()
+{
+    T item;
+
+    ASSERT(!IsEmpty());
+    item = heap[0].item;
+    RemoveAt(0);
+    return item;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Remove
+//	Remove a specific item from the heap.  Must be in the heap.
+//
+//	Unless the items keep their slots, this has to search the heap,
+//	so it is O(n).
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Remove(T item)
+{
+    int i = Find(item);
+
+    ASSERT(i >= 0);
+    RemoveAt(i);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::IsInHeap
+//	Return TRUE if the item is in the heap.
+//----------------------------------------------------------------------
+
+template <class T>
+bool
+Heap<T>::IsInHeap(T item) const
+{
+    return Find(item) >= 0;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Apply
+//	Apply function to every item in the heap.
+//
+//	"func" -- the function to apply
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Apply(void (*func)(T)) const
+{
+    for (int i = 0; i < numInHeap; i++)
+	(*func)(heap[i].item);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Less
+//	Return TRUE if heap[i] should come out before heap[j]: either it
+//	is smaller, or they are equal and heap[i] went in first.
+//----------------------------------------------------------------------
+
+template <class T>
+bool
+Heap<T>::Less(int i, int j) const
+{
+    int c = compare(heap[i].item, heap[j].item);
+
+    if (c != 0)
+	return c < 0;
+    return (int)(heap[i].order - heap[j].order) < 0;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Swap
+//	Exchange two slots of the heap array.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Swap(int i, int j)
+{
+    HeapElement<T> tmp = heap[i];
+
+    heap[i] = heap[j];
+    heap[j] = tmp;
+    SetIndex(i);
+    SetIndex(j);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::SetIndex
+//	Record in heap[i]'s item, if it keeps its slot, that it is at i.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SetIndex(int i)
+{
+    if (indexOf != NULL)
+	*indexOf(heap[i].item) = i;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::SiftUp
+//	Move heap[i] towards the root until its parent is smaller.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SiftUp(int i)
+{
+    while (i > 0 && Less(i, (i - 1) / 2)) {
+	Swap(i, (i - 1) / 2);
+	i = (i - 1) / 2;
+    }
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::SiftDown
+//	Move heap[i] away from the root until both its children are
+//	larger.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SiftDown(int i)
+{
+    for (;;) {
+	int smallest = i;
+	int left = 2 * i + 1, right = 2 * i + 2;
+
+	if (left < numInHeap && Less(left, smallest))
+	    smallest = left;
+	if (right < numInHeap && Less(right, smallest))
+	    smallest = right;
+	if (smallest == i)
+	    return;
+	Swap(i, smallest);
+	i = smallest;
+    }
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Find
+//	Return the index of an item in the heap array, or -1 if it
+//	isn't in the heap.  If the item keeps its slot, we just check
+//	that the slot is in this heap and holds the item.
+//----------------------------------------------------------------------
+
+template <class T>
+int
+Heap<T>::Find(T item) const
+{
+    if (indexOf != NULL) {
+	int i = *indexOf(item);
+
+	return (i >= 0 && i < numInHeap && heap[i].item == item) ? i : -1;
+    }
+    for (int i = 0; i < numInHeap; i++)
+	if (heap[i].item == item)
+	    return i;
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::RemoveAt
+//	Remove heap[i], by moving the last item into its slot and
+//	letting that item find its place.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::RemoveAt(int i)
+{
+    ASSERT(i >= 0 && i < numInHeap);
+    if (indexOf != NULL)
+	*indexOf(heap[i].item) = -1;
+    numInHeap--;
+    if (i == numInHeap)
+	return;
+    heap[i] = heap[numInHeap];
+    SetIndex(i);
+    SiftDown(i);
+    SiftUp(i);
+}
+
+//----------------------------------------------------------------------
+// Heap::SanityCheck
+//      Test whether this is still a legal heap.
+//
+//	Test: is every item no smaller than its parent?
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SanityCheck() const
+{
+    ASSERT(numInHeap >= 0 && numInHeap <= size);
+    for (int i = 1; i < numInHeap; i++)
+	ASSERT(!Less(i, (i - 1) / 2));
+    for (int i = 0; i < numInHeap; i++)
+	ASSERT(indexOf == NULL || *indexOf(heap[i].item) == i);
+}
+
+//----------------------------------------------------------------------
+// Heap::SelfTest
+//      Test whether this module is working.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SelfTest(T *p, int numEntries)
+{
+    int i;
+    T *q = new T[numEntries];
+
+    SanityCheck();
+    ASSERT(IsEmpty());
+
+    for (i = 0; i < numEntries; i++) {
+	Insert(p[i]);
+	ASSERT(IsInHeap(p[i]));
+	ASSERT(!IsEmpty());
+    }
+    SanityCheck();
+
+    // take one out of the middle and put it back
+    Remove(p[numEntries / 2]);
+    ASSERT(!IsInHeap(p[numEntries / 2]));
+    SanityCheck();
+    Insert(p[numEntries / 2]);
+
+    // should be able to get out everything we put in
+    for (i = 0; i < numEntries; i++) {
+	q[i] = RemoveFront();
+	ASSERT(!IsInHeap(q[i]));
+	SanityCheck();
+    }
+    ASSERT(IsEmpty());
+
+    // make sure everything came out in the right order
+    for (i = 0; i < (numEntries - 1); i++) {
+	ASSERT(compare(q[i], q[i + 1]) <= 0);
+    }
+    delete [] q;
+}
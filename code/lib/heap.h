@@ -0,0 +1,101 @@
+// heap.h
+//	Data structures to manage a priority queue, kept as a binary heap
+//	in an array.
+//
+//	A heap does the same job as a SortedList -- "RemoveFront" always
+//	returns the smallest item -- but inserting and removing an item
+//	is O(log n) instead of O(n) (removing one other than the smallest
+//	is O(log n) only if the items keep their slots; see below).  Items that compare equal come out
+//	in the order they were put in, just as they would on a SortedList.
+//
+//	As with lists, allocation and deallocation of the items in the
+//	heap are to be done by the caller.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef HEAP_H
+#define HEAP_H
+
+#include "copyright.h"
+#include "debug.h"
+
+// The following class defines one slot in the heap array.  Each item
+// is stamped with the order it was inserted in, to break ties.
+//
+// This class is private to this module.  Made public for notational
+// convenience.
+
+template <class T>
+class HeapElement {
+  public:
+    T item;			// item in the heap
+    unsigned int order;		// when it was inserted, for FIFO ties
+};
+
+// The following class defines a "heap".  All types to be put in
+// a heap must have a "Compare" function defined, just as for a
+// SortedList:
+//	   int Compare(T x, T y)
+//		returns -1 if x < y
+//		returns 0 if x == y
+//		returns 1 if x > y
+//
+// The comparison of an item must not change while it is in the heap;
+// take the item out, change it, and put it back in instead.
+//
+// To find an item in the heap (for Remove and IsInHeap) without
+// searching it, the heap can keep each item's slot in the item itself,
+// as the pending interrupt queue does: give the constructor a function
+// returning a pointer to an int in the item, set to -1 before the item
+// is first inserted.  Otherwise, Remove and IsInHeap are O(n).
+
+template <class T>
+class Heap {
+  public:
+    Heap(int (*comp)(T x, T y), int *(*index)(T x) = NULL);
+				// initialize an empty heap
+    ~Heap();			// de-allocate the heap
+
+    void Insert(T item);	// put an item in the heap
+    T Front() { ASSERT(!IsEmpty()); return heap[0].item; }
+				// Return the smallest item,
+				// without removing it
+    T RemoveFront();		// Take the smallest item out of the heap
+    void Remove(T item);	// Remove specific item from the heap
+    bool IsInHeap(T item) const;// is the item in the heap?
+    int NumInHeap() { return numInHeap; }
+				// how many items in the heap?
+    bool IsEmpty() { return (numInHeap == 0); }
+				// is the heap empty?
+    void Apply(void (*f)(T)) const;
+				// apply function to all items in the
+				// heap, in no particular order
+
+    void SanityCheck() const;	// has this heap been corrupted?
+    void SelfTest(T *p, int numEntries);
+				// verify module is working
+
+  private:
+    int (*compare)(T x, T y);	// function for ordering items
+    int *(*indexOf)(T x);	// where an item keeps its slot, or NULL
+    HeapElement<T> *heap;	// heap[0] is the smallest; the children
+				// of heap[i] are heap[2i+1] and heap[2i+2]
+    int numInHeap;		// number of items in the heap
+    int size;			// number of slots allocated
+    unsigned int nextOrder;	// stamp for the next item inserted
+
+    bool Less(int i, int j) const;	// does heap[i] go before heap[j]?
+    void Swap(int i, int j);
+    void SetIndex(int i);	// tell heap[i] where it is
+    void SiftUp(int i);		// restore the heap property after
+    void SiftDown(int i);	//   heap[i] got smaller/larger
+    int Find(T item) const;	// index of an item, or -1
+    void RemoveAt(int i);	// remove heap[i]
+};
+
+#include "heap.cc"		// templates are really like macros
+				// so needs to be included in every
+				// file that uses the template
+#endif // HEAP_H
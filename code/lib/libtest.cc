@@ -1,6 +1,7 @@
 // libtest.cc 
 //	Driver code to call self-test routines for standard library
-//	classes -- bitmaps, lists, sorted lists, and hash tables.
+//	classes -- bitmaps, lists, intrusive lists, sorted lists, heaps,
+//	and hash tables.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -10,6 +11,7 @@
 #include "libtest.h"
 #include "bitmap.h"
 #include "list.h"
+#include "heap.h"
 #include "hash.h"
 #include "sysdep.h"
 
@@ -53,6 +55,13 @@ HashKey(char *str) {
 // Array of values to be inserted into a List or SortedList. 
 static int listTestVector[] = { 9, 5, 7 };
 
+// Objects to be put on an intrusive LinkedList.
+class LinkedTestItem {
+  public:
+    ListLink<LinkedTestItem> link;
+};
+static LinkedTestItem linkedTestVector[4];
+
 // Array of values to be inserted into the HashTable
 // There are enough here to force a ReHash().
 static char *hashTestVector[] = { "0", "1", "2", "3", "4", "5", "6",
@@ -60,7 +69,7 @@ static char *hashTestVector[] = { "0", "1", "2", "3", "4", "5", "6",
 
 //----------------------------------------------------------------------
 // LibSelfTest
-//	Run self tests on bitmaps, lists, sorted lists, and 
+//	Run self tests on bitmaps, lists, sorted lists, heaps, and 
 //	hash tables.
 //----------------------------------------------------------------------
 
@@ -68,18 +77,26 @@ void
 LibSelfTest () {
     BitMap *map = new BitMap(200);
     List<int> *list = new List<int>;
+    LinkedList<LinkedTestItem, &LinkedTestItem::link> *linkedList =
+	new LinkedList<LinkedTestItem, &LinkedTestItem::link>;
     SortedList<int> *sortList = new SortedList<int>(IntCompare);
+    Heap<int> *heap = new Heap<int>(IntCompare);
     HashTable<int, char *> *hashTable = 
 	new HashTable<int, char *>(HashKey, HashInt);
 	
 		
     map->SelfTest();
     list->SelfTest(listTestVector, sizeof(listTestVector)/sizeof(int));
+    linkedList->SelfTest(linkedTestVector,
+	sizeof(linkedTestVector)/sizeof(LinkedTestItem));
     sortList->SelfTest(listTestVector, sizeof(listTestVector)/sizeof(int));
+    heap->SelfTest(listTestVector, sizeof(listTestVector)/sizeof(int));
     hashTable->SelfTest(hashTestVector, sizeof(hashTestVector)/sizeof(char *));
 
     delete map;
     delete list;
+    delete linkedList;
     delete sortList;
+    delete heap;
     delete hashTable;
 }
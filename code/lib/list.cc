@@ -18,6 +18,9 @@
 
 #include "copyright.h"
 
+template <class T>
+Slab ListElement<T>::slab = { "ListElement", sizeof(ListElement<T>) };
+
 //----------------------------------------------------------------------
 // ListElement<T>::ListElement
 // 	Initialize a list element, so it can be added somewhere on a list.
@@ -379,3 +382,241 @@ SortedList<T>::SelfTest(T *p, int numEntries)
 
      delete q;
 }
+
+//----------------------------------------------------------------------
+// LinkedList<T, link>::LinkedList
+//	Initialize an intrusive list, empty to start with.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+LinkedList<T, link>::LinkedList()
+{ 
+    first = last = NULL; 
+    numInList = 0;
+}
+
+//----------------------------------------------------------------------
+// LinkedList<T, link>::~LinkedList
+//	Prepare a list for deallocation.  
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+LinkedList<T, link>::~LinkedList()
+{ 
+    ASSERT(IsEmpty());		// make sure list is empty
+}
+
+//----------------------------------------------------------------------
+// LinkedList<T, link>::InsertAfter
+//	Link "item" into the list after "prev", or at the front if "prev"
+//	is NULL.  The item must not be on any list that uses the same
+//	link.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+LinkedList<T, link>::InsertAfter(T *prev, T *item)
+{
+    ListLink<T> *l = &(item->*link);
+
+    ASSERT(l->list == NULL);
+    l->prev = prev;
+    if (prev == NULL) {		// put it first
+	l->next = first;
+	first = item;
+    } else {
+	l->next = (prev->*link).next;
+	(prev->*link).next = item;
+    }
+    if (l->next == NULL) {
+	last = item;
+    } else {
+	(l->next->*link).prev = item;
+    }
+    l->list = this;
+    numInList++;
+}
+
+//----------------------------------------------------------------------
+// LinkedList<T, link>::Append, Prepend
+//      Put "item" on the end (front) of the list.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+LinkedList<T, link>::Append(T *item)
+{
+    InsertAfter(last, item);
+}
+
+template <class T, ListLink<T> T::*link>
+void
+LinkedList<T, link>::Prepend(T *item)
+{
+    InsertAfter(NULL, item);
+}
+
+//----------------------------------------------------------------------
+// LinkedList<T, link>::Remove
+//      Unlink "item" from the list, which it must be on.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+LinkedList<T, link>::Remove(T *item)
+{
+    ListLink<T> *l = &(item->*link);
+
+    ASSERT(IsInList(item));
+    if (l->prev == NULL) {
+	first = l->next;
+    } else {
+	(l->prev->*link).next = l->next;
+    }
+    if (l->next == NULL) {
+	last = l->prev;
+    } else {
+	(l->next->*link).prev = l->prev;
+    }
+    l->prev = l->next = NULL;
+    l->list = NULL;
+    numInList--;
+}
+
+//----------------------------------------------------------------------
+// LinkedList<T, link>::RemoveFront
+//      Remove the first item from the front of the list, which must
+//	not be empty.
+//
+// Returns:
+//	The removed item.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+T *
+LinkedList<T, link>::RemoveFront()
+{
+    T *item = first;
+
+    ASSERT(!IsEmpty());
+    Remove(item);
+    return item;
+}
+
+//----------------------------------------------------------------------
+// LinkedList<T, link>::Apply
+//      Apply function to every item on a list.
+//
+//	"func" -- the function to apply
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+LinkedList<T, link>::Apply(void (*func)(T *)) const
+{ 
+    T *ptr, *next;
+
+    for (ptr = first; ptr != NULL; ptr = next) {
+	next = (ptr->*link).next;	// in case "func" unlinks it
+	(*func)(ptr);
+    }
+}
+
+//----------------------------------------------------------------------
+// SortedLinkedList::Insert
+//      Insert an item onto the list in sorted order, after any items
+//	that are equal to it.
+//
+//	We search from the back, since new items (e.g. interrupts
+//	scheduled for the future) usually go at or near the end.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+SortedLinkedList<T, link>::Insert(T *item)
+{
+    T *ptr = this->last;
+
+    while (ptr != NULL && compare(item, ptr) < 0) {
+	ptr = (ptr->*link).prev;
+    }
+    this->InsertAfter(ptr, item);
+}
+
+//----------------------------------------------------------------------
+// LinkedList::SanityCheck
+//      Test whether this is still a legal list: the links agree with
+//	each other in both directions, and with the count.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+LinkedList<T, link>::SanityCheck() const
+{
+    T *ptr, *prev = NULL;
+    int numFound = 0;
+
+    for (ptr = first; ptr != NULL; prev = ptr, ptr = (ptr->*link).next) {
+	ASSERT((ptr->*link).prev == prev);
+	ASSERT((ptr->*link).list == this);
+	numFound++;
+    }
+    ASSERT(last == prev);
+    ASSERT(numFound == numInList);
+}
+
+//----------------------------------------------------------------------
+// SortedLinkedList::SanityCheck
+//      Test whether this is still a legal sorted list.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+SortedLinkedList<T, link>::SanityCheck() const
+{
+    T *ptr;
+
+    LinkedList<T, link>::SanityCheck();
+    for (ptr = this->first; ptr != NULL && ptr != this->last;
+					ptr = (ptr->*link).next) {
+	ASSERT(compare(ptr, (ptr->*link).next) <= 0);
+    }
+}
+
+//----------------------------------------------------------------------
+// LinkedList::SelfTest
+//      Test whether this module is working: put the items on the
+//	list, and take them off again, from the middle, back and front.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+LinkedList<T, link>::SelfTest(T *p, int numEntries)
+{
+    int i;
+
+    SanityCheck();
+    ASSERT(IsEmpty() && (first == NULL));
+
+    for (i = 0; i < numEntries; i++) {
+	Append(&p[i]);
+	ASSERT(IsInList(&p[i]));
+	ASSERT(!IsEmpty());
+    }
+    SanityCheck();
+    ASSERT(Front() == &p[0]);
+
+    Remove(&p[numEntries / 2]);	// from the middle
+    ASSERT(!IsInList(&p[numEntries / 2]));
+    SanityCheck();
+    Prepend(&p[numEntries / 2]);
+    ASSERT(RemoveFront() == &p[numEntries / 2]);
+    for (i = numEntries - 1; i >= 0; i--) {
+	if (i != numEntries / 2) {
+	    Remove(&p[i]);	// from the back
+	    ASSERT(!IsInList(&p[i]));
+	}
+    }
+    ASSERT(IsEmpty());
+    SanityCheck();
+}
@@ -15,6 +15,7 @@
 
 #include "copyright.h"
 #include "debug.h"
+#include "slab.h"
 
 // The following class defines a "list element" -- which is
 // used to keep track of one item on a list.  It is equivalent to a
@@ -30,6 +31,13 @@ class ListElement {
     ListElement(T itm); 	// initialize a list element
     ListElement *next;	     	// next element on list, NULL if this is last
     T item; 	   	     	// item on the list
+
+    void *operator new(size_t size) { return slab.Alloc(); }
+    void operator delete(void *p) { slab.Free(p); }
+				// elements come from a slab, one
+				// per type of item
+  private:
+    static Slab slab;
 };
 
 // The following class defines a "list" -- a singly linked list of
@@ -136,6 +144,100 @@ class ListIterator {
     ListElement<T> *current;	// where we are in the list
 };
 
+// The following class defines a "list link" -- the pointers that put
+// an object on an "intrusive" list.  Instead of allocating a
+// ListElement for each item, the object to be put on the list has a
+// ListLink in it, so that putting it on a list or taking it off
+// (even from the middle) takes no allocation and no searching.
+//
+// The catch is that an object can only be on one list per ListLink
+// it has.
+
+template <class T>
+class ListLink {
+  public:
+    ListLink() { prev = next = NULL; list = NULL; }
+
+    T *prev;			// previous item on the list, NULL if first
+    T *next;			// next item on the list, NULL if last
+    void *list;			// the list we are on, NULL if none
+};
+
+// The following class defines an intrusive doubly linked list of
+// objects of class T, linked through the ListLink "link" in each
+// of them, e.g.:
+//
+//	LinkedList<Thread, &Thread::queueLink> *queue;
+//
+// It has the same interface as List, except that every operation
+// takes constant time, apart from Apply.
+
+template <class T, ListLink<T> T::*link>
+class LinkedList {
+  public:
+    LinkedList();		// initialize the list
+    virtual ~LinkedList();	// de-allocate the list
+
+    void Prepend(T *item);	// Put item at the beginning of the list
+    void Append(T *item); 	// Put item at the end of the list
+
+    T *Front() { return first; }
+    				// Return first item on list
+				// without removing it
+    T *Next(T *item) { return (item->*link).next; }
+				// Return the item after "item",
+				// NULL if it's the last
+    T *RemoveFront(); 		// Take item off the front of the list
+    void Remove(T *item); 	// Remove specific item from list
+
+    bool IsInList(T *item) const { return (item->*link).list == this; }
+				// is the item in the list?
+
+    unsigned int NumInList() { return numInList;};
+    				// how many items in the list?
+    bool IsEmpty() { return (numInList == 0); };
+    				// is the list empty? 
+
+    void Apply(void (*f)(T *)) const; 
+    				// apply function to all elements in list
+
+    virtual void SanityCheck() const;	
+				// has this list been corrupted?
+    void SelfTest(T *p, int numEntries);
+				// verify module is working
+
+  protected:
+    T *first;		  	// Head of the list, NULL if list is empty
+    T *last;			// Last element of list
+    int numInList;		// number of elements in list
+
+    void InsertAfter(T *prev, T *item);
+				// put "item" after "prev" (at the front,
+				// if "prev" is NULL)
+};
+
+// The following class defines a sorted intrusive list, arranged so
+// that "RemoveFront" always returns the smallest item.  Items that
+// compare equal come off in the order they were inserted.
+
+template <class T, ListLink<T> T::*link>
+class SortedLinkedList : public LinkedList<T, link> {
+  public:
+    SortedLinkedList(int (*comp)(T *x, T *y)) : LinkedList<T, link>()
+				{ compare = comp;};
+    ~SortedLinkedList() {};	// base class destructor called automatically
+
+    void Insert(T *item); 	// insert an item onto the list in sorted order
+
+    void SanityCheck() const;	// has this list been corrupted?
+
+  private:
+    int (*compare)(T *x, T *y);	// function for sorting list elements
+
+    void Prepend(T *item) { Insert(item); }
+    void Append(T *item) { Insert(item); }
+};
+
 #include "list.cc"		// templates are really like macros
 				// so needs to be included in every
 				// file that uses the template
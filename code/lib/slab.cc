@@ -0,0 +1,120 @@
+// slab.cc
+//	Routines to manage slab allocators.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "slab.h"
+#include "debug.h"
+
+// Every slab that has been used, most recently first, for PrintAll.
+static Slab *allSlabs = NULL;
+
+//----------------------------------------------------------------------
+// Slab::Alloc
+// 	Return memory for one object, from the free list if there's
+//	anything on it.
+//----------------------------------------------------------------------
+
+void *
+Slab::Alloc()
+{
+    void *object;
+
+    if (free == NULL) {
+	Grow();
+    }
+    object = free;
+    free = *(void **) object;
+    numAllocs++;
+    if (++numInUse > maxInUse) {
+	maxInUse = numInUse;
+    }
+    return object;
+}
+
+//----------------------------------------------------------------------
+// Slab::Free
+// 	Put an object's memory back on the free list.
+//----------------------------------------------------------------------
+
+void
+Slab::Free(void *object)
+{
+    if (object == NULL) {
+	return;
+    }
+    *(void **) object = free;
+    free = object;
+    numFrees++;
+    numInUse--;
+}
+
+//----------------------------------------------------------------------
+// Slab::Grow
+// 	Get memory for SlabObjects more objects from the host, and put
+//	them all on the free list.  Each object is rounded up to a
+//	multiple of 8 bytes, so they are all aligned for anything.
+//----------------------------------------------------------------------
+
+void
+Slab::Grow()
+{
+    unsigned int unit = (size + 7) & ~7;
+    char *slab;
+
+    ASSERT(size > 0);
+    if (unit < sizeof(void *)) {
+	unit = sizeof(void *);
+    }
+    if (numSlabs == 0) {	// first use
+	nextSlab = allSlabs;
+	allSlabs = this;
+    }
+    numSlabs++;
+
+    slab = new char[unit * SlabObjects];
+    for (int i = SlabObjects - 1; i >= 0; i--) {
+	*(void **) &slab[i * unit] = free;
+	free = &slab[i * unit];
+    }
+}
+
+//----------------------------------------------------------------------
+// Slab::PrintAll
+// 	Print, for each kind of object, how many were allocated and how
+//	many host allocations that took.  Slabs with the same name (for
+//	instance, the ListElements of lists of different types) are
+//	added together.
+//----------------------------------------------------------------------
+
+void
+Slab::PrintAll()
+{
+    for (Slab *s = allSlabs; s != NULL; s = s->nextSlab) {
+	int allocs = 0, inUse = 0, peak = 0, slabs = 0;
+	Slab *t;
+
+	for (t = allSlabs; t != s; t = t->nextSlab) {
+	    if (strcmp(t->name, s->name) == 0) {
+		break;		// already printed
+	    }
+	}
+	if (t != s) {
+	    continue;
+	}
+	for (t = s; t != NULL; t = t->nextSlab) {
+	    if (strcmp(t->name, s->name) == 0) {
+		allocs += t->numAllocs;
+		inUse += t->numInUse;
+		peak += t->maxInUse;
+		slabs += t->numSlabs;
+	    }
+	}
+	cout << "Slab " << s->name << ": allocs " << allocs << ", in use "
+	     << inUse << " (peak " << peak << "), host allocations "
+	     << slabs << "\n";
+    }
+}
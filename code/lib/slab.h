@@ -0,0 +1,61 @@
+// slab.h
+//	Data structures for a simple slab allocator: a free list of
+//	objects of a single size, which gets more memory from the host
+//	a slab of objects at a time, and never gives it back.
+//
+//	Objects that are created and deleted all the time by the
+//	simulation (pending interrupts, list elements, threads, mail)
+//	get their memory from a slab of their own by defining their own
+//	"operator new" and "operator delete"; after the first few, a
+//	"new" is just taking an object off the free list.
+//
+//	NOTE: Mutual exclusion must be provided by the caller; in Nachos,
+//	there is only one host thread, and no slab is used by a signal
+//	handler.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include "copyright.h"
+#include "sysdep.h"
+
+// Number of objects we get from the host at a time.
+const int SlabObjects = 64;
+
+// The following class defines a slab allocator for objects of one
+// size.  A slab is declared, usually as a static member of the class
+// it allocates, with only its name and object size given:
+//
+//	Slab Foo::slab = { "Foo", sizeof(Foo) };
+//
+// so that it is set up before any constructor runs, and can be used to
+// allocate static objects.  That is why the fields are public; only
+// the first two should be set by anyone else.
+
+class Slab {
+  public:
+    const char *name;		// for Print
+    unsigned int size;		// size of the objects, in bytes
+
+    void *Alloc();		// return memory for an object
+    void Free(void *object);	// take it back
+
+    static void PrintAll();	// print how many objects each slab
+				// handed out
+
+    void *free;			// free objects, linked through their
+				// first word
+    int numAllocs, numFrees;	// objects handed out and taken back
+    int numInUse, maxInUse;	// objects in use, now and at most
+    int numSlabs;		// times we had to get memory from
+				// the host
+    Slab *nextSlab;		// all slabs that have been used
+
+    void Grow();		// get another slab from the host
+};
+
+#endif // SLAB_H
@@ -17,12 +17,16 @@ using namespace::std;
 #include "stdlib.h"
 #include "stdio.h"
 #include "string.h"
+#include "strings.h"
 
 // Process control: abort, exit, and sleep
 extern void Abort();
 extern void Exit(int exitCode);
 extern void Delay(int seconds);
 
+// Time on the host's clock, in seconds, for timing Nachos itself
+extern double HostTime();
+
 // Initialize system so that cleanUp routine is called when user hits ctl-C
 extern void CallOnUserAbort(void (*cleanup)(int));
 
@@ -99,53 +99,62 @@ PrintSector(bool writing, int sector, char *data)
 
 //----------------------------------------------------------------------
 // Disk::ReadRequest/WriteRequest
-// 	Simulate a request to read/write a single disk sector
+// 	Simulate a request to read/write a run of consecutive disk sectors
 //	   Do the read/write immediately to the UNIX file
 //	   Set up an interrupt handler to be called later,
 //	      that will notify the caller when the simulator says
 //	      the operation has completed.
 //
 //	Note that a disk only allows an entire sector to be read/written,
-//	not part of a sector.
+//	not part of a sector.  A request for several sectors must stay
+//	on one track; once the head reaches the first sector, the rest
+//	just stream past it, one sector per RotationTime.
 //
-//	"sectorNumber" -- the disk sector to read/write
+//	"sectorNumber" -- the first disk sector to read/write
 //	"data" -- the bytes to be written, the buffer to hold the incoming bytes
+//	"numSectors" -- the number of sectors to read/write
 //----------------------------------------------------------------------
 
-void Disk::ReadRequest(int sectorNumber, char *data)
+void Disk::ReadRequest(int sectorNumber, char *data, int numSectors)
 {
-    int ticks = ComputeLatency(sectorNumber, FALSE);
+    int endSector = sectorNumber + numSectors - 1;
+    int ticks = ComputeLatency(sectorNumber, FALSE) + (numSectors - 1) * RotationTime;
 
     ASSERT(!active); // only one request at a time
-    ASSERT((sectorNumber >= 0) && (sectorNumber < NumSectors));
+    ASSERT((sectorNumber >= 0) && (endSector < NumSectors));
+    ASSERT(numSectors > 0 && sectorNumber / SectorsPerTrack == endSector / SectorsPerTrack);
 
-    DEBUG(dbgDisk, "Reading from sector " << sectorNumber);
+    DEBUG(dbgDisk, "Reading from sector " << sectorNumber << ", " << numSectors << " sectors");
     Lseek(fileno, SectorSize * sectorNumber + MagicSize, 0);
-    Read(fileno, data, SectorSize);
+    Read(fileno, data, SectorSize * numSectors);
     if (debug->IsEnabled('d'))
-        PrintSector(FALSE, sectorNumber, data);
+        for (int i = 0; i < numSectors; i++)
+            PrintSector(FALSE, sectorNumber + i, data + i * SectorSize);
 
     active = TRUE;
-    UpdateLast(sectorNumber);
+    UpdateLast(endSector);
     kernel->stats->numDiskReads++;
     kernel->interrupt->Schedule(this, ticks, DiskInt);
 }
 
-void Disk::WriteRequest(int sectorNumber, char *data)
+void Disk::WriteRequest(int sectorNumber, char *data, int numSectors)
 {
-    int ticks = ComputeLatency(sectorNumber, TRUE);
+    int endSector = sectorNumber + numSectors - 1;
+    int ticks = ComputeLatency(sectorNumber, TRUE) + (numSectors - 1) * RotationTime;
 
     ASSERT(!active);
-    ASSERT((sectorNumber >= 0) && (sectorNumber < NumSectors));
+    ASSERT((sectorNumber >= 0) && (endSector < NumSectors));
+    ASSERT(numSectors > 0 && sectorNumber / SectorsPerTrack == endSector / SectorsPerTrack);
 
-    DEBUG(dbgDisk, "Writing to sector " << sectorNumber);
+    DEBUG(dbgDisk, "Writing to sector " << sectorNumber << ", " << numSectors << " sectors");
     Lseek(fileno, SectorSize * sectorNumber + MagicSize, 0);
-    WriteFile(fileno, data, SectorSize);
+    WriteFile(fileno, data, SectorSize * numSectors);
     if (debug->IsEnabled('d'))
-        PrintSector(TRUE, sectorNumber, data);
+        for (int i = 0; i < numSectors; i++)
+            PrintSector(TRUE, sectorNumber + i, data + i * SectorSize);
 
     active = TRUE;
-    UpdateLast(sectorNumber);
+    UpdateLast(endSector);
     kernel->stats->numDiskWrites++;
     kernel->interrupt->Schedule(this, ticks, DiskInt);
 }
@@ -61,12 +61,14 @@ public:
                                            // when each request completes.
     ~Disk();                               // Deallocate the disk.
 
-    void ReadRequest(int sectorNumber, char *data);
-    // Read/write an single disk sector.
+    void ReadRequest(int sectorNumber, char *data, int numSectors = 1);
+    // Read/write "numSectors" consecutive
+    // disk sectors on one track (usually
+    // just one sector).
     // These routines send a request to
     // the disk and return immediately.
     // Only one request allowed at a time!
-    void WriteRequest(int sectorNumber, char *data);
+    void WriteRequest(int sectorNumber, char *data, int numSectors = 1);
 
     void CallBack(); // Invoked when disk request
                      // finishes. In turn calls, callWhenDone.
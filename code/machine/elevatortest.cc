@@ -4,6 +4,10 @@
 //	in practice there will be multiple riders and multiple elevators,
 //	each with its own thread.
 //
+//	Under the EDF scheduler, the controller is a periodic real-time
+//	thread: instead of sleeping until it is told of an event, it
+//	polls for events once a period.
+//
 // Copyright (c) 1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
 // of liability and disclaimer of warranty provisions.
@@ -13,6 +17,13 @@
 #include "elevator.h"
 #include "synch.h"
 #include "thread.h"
+#include "main.h"
+
+// The controller's real-time parameters, under EDF: it checks for
+// events every ControllerPeriod ticks, which must take no more than
+// ControllerBudget ticks, and be done by the end of the period.
+const int ControllerPeriod = 200;
+const int ControllerBudget = 50;
 
 // Data structures to control elevator device self test.
 // Definition private to this module. 
@@ -50,7 +61,10 @@ class ElevatorInspector : public CallBackObj{
 	
         while ((event = elevators->getNextControllerEvent(
         				floor, elevator)) == NoEvent) {
-            controllerWakeup->P();
+	    if (kernel->currentThread->getRealTime() != NULL)
+		kernel->currentThread->WaitForNextPeriod();	// poll
+	    else
+		controllerWakeup->P();
         }
         return event;
     }
@@ -129,7 +143,7 @@ ElevatorInspector::RiderTest () {
 //----------------------------------------------------------------------
 // ElevatorInspector::ControllerTest
 //	Behave like an elevator controller, for testing the
-//	elevator simulation.
+//	elevator simulation.  Under EDF, become periodic first.
 //----------------------------------------------------------------------
 
 void
@@ -137,6 +151,12 @@ ElevatorInspector::ControllerTest () {
     int floor, elevator;
     ElevatorEvent event;
 
+    if (kernel->scheduler->getSchedulerType() == EDF) {
+	bool admitted = kernel->scheduler->Admit(kernel->currentThread,
+			ControllerPeriod, ControllerBudget, ControllerPeriod);
+	ASSERT(admitted);
+    }
+
     // assume elevator starts on ground floor    
     ASSERT(elevators->WhereIsElevator(0) == 0);	
     event = WaitForNextControllerEvent(&floor, &elevator);
@@ -23,6 +23,7 @@
 #include "copyright.h"
 #include "interrupt.h"
 #include "main.h"
+#include "synchprof.h"
 
 // String definitions for debugging messages
 
@@ -41,33 +42,216 @@ static char *intTypeNames[] = {"timer", "disk", "console write",
 //	"kind" is the hardware device that generated the interrupt
 //----------------------------------------------------------------------
 
+Slab PendingInterrupt::slab = { "PendingInterrupt", sizeof(PendingInterrupt) };
+
 PendingInterrupt::PendingInterrupt(CallBackObj *callOnInt,
                                    int time, IntType kind)
 {
     callOnInterrupt = callOnInt;
     when = time;
     type = kind;
+    order = 0;
+    index = -1;
+}
+
+const int InitialPendingSize = 16;
+
+//----------------------------------------------------------------------
+// PendingQueue::PendingQueue
+//	Initialize the queue of pending interrupts, empty to start with.
+//----------------------------------------------------------------------
+
+PendingQueue::PendingQueue()
+{
+    size = InitialPendingSize;
+    heap = new PendingInterrupt *[size];
+    numInQueue = 0;
+    nextOrder = 0;
 }
 
 //----------------------------------------------------------------------
-// PendingCompare
-//	Compare to interrupts based on which should occur first.
+// PendingQueue::~PendingQueue
+//	De-allocate the queue, and any interrupts still on it.
 //----------------------------------------------------------------------
 
-static int
-PendingCompare(PendingInterrupt *x, PendingInterrupt *y)
+PendingQueue::~PendingQueue()
 {
-    if (x->when < y->when)
+    while (!IsEmpty())
     {
-        return -1;
+        delete RemoveFront();
     }
-    else if (x->when > y->when)
+    delete[] heap;
+}
+
+//----------------------------------------------------------------------
+// PendingQueue::Before
+//	Is interrupt "x" to occur before interrupt "y"?  Interrupts due
+//	at the same time occur in the order they were scheduled.
+//----------------------------------------------------------------------
+
+bool PendingQueue::Before(PendingInterrupt *x, PendingInterrupt *y) const
+{
+    if (x->when != y->when)
     {
-        return 1;
+        return x->when < y->when;
     }
-    else
+    return (int)(x->order - y->order) < 0; // in case the stamps wrapped
+}
+
+//----------------------------------------------------------------------
+// PendingQueue::Place
+//	Put an interrupt in slot "i" of the heap, and tell it so.
+//----------------------------------------------------------------------
+
+void PendingQueue::Place(int i, PendingInterrupt *item)
+{
+    heap[i] = item;
+    item->index = i;
+}
+
+//----------------------------------------------------------------------
+// PendingQueue::SiftUp, SiftDown
+//	Move heap[i] up (towards the front) or down until it is after
+//	its parent and before its children.  The item being moved is
+//	held aside, and only put down once its slot is found.
+//----------------------------------------------------------------------
+
+void PendingQueue::SiftUp(int i)
+{
+    PendingInterrupt *item = heap[i];
+
+    while (i > 0 && Before(item, heap[(i - 1) / 4]))
+    {
+        Place(i, heap[(i - 1) / 4]);
+        i = (i - 1) / 4;
+    }
+    Place(i, item);
+}
+
+void PendingQueue::SiftDown(int i)
+{
+    PendingInterrupt *item = heap[i];
+
+    for (;;)
+    {
+        int first = 4 * i + 1;
+        int last = (first + 4 < numInQueue) ? first + 4 : numInQueue;
+        int child = first;
+
+        if (first >= numInQueue)
+        {
+            break;
+        }
+        for (int c = first + 1; c < last; c++)
+        {
+            if (Before(heap[c], heap[child]))
+            {
+                child = c;
+            }
+        }
+        if (!Before(heap[child], item))
+        {
+            break;
+        }
+        Place(i, heap[child]);
+        i = child;
+    }
+    Place(i, item);
+}
+
+//----------------------------------------------------------------------
+// PendingQueue::Insert
+//	Put an interrupt on the queue, growing the array if it is full.
+//----------------------------------------------------------------------
+
+void PendingQueue::Insert(PendingInterrupt *item)
+{
+    ASSERT(item->index == -1);
+    if (numInQueue == size)
+    {
+        PendingInterrupt **bigger = new PendingInterrupt *[size * 2];
+
+        for (int i = 0; i < numInQueue; i++)
+        {
+            bigger[i] = heap[i];
+        }
+        delete[] heap;
+        heap = bigger;
+        size *= 2;
+    }
+    item->order = nextOrder++;
+    heap[numInQueue++] = item;
+    SiftUp(numInQueue - 1);
+}
+
+//----------------------------------------------------------------------
+// PendingQueue::RemoveAt, RemoveFront
+//	Take an interrupt off the queue: move the last one into its
+//	slot, and sift that one whichever way it needs to go.
+//----------------------------------------------------------------------
+
+void PendingQueue::RemoveAt(int i)
+{
+    PendingInterrupt *item;
+
+    ASSERT(i >= 0 && i < numInQueue);	// it must be on the queue
+    item = heap[i];
+    numInQueue--;
+    if (i < numInQueue)
+    {
+        Place(i, heap[numInQueue]);
+        if (i > 0 && Before(heap[i], heap[(i - 1) / 4]))
+        {
+            SiftUp(i);
+        }
+        else
+        {
+            SiftDown(i);
+        }
+    }
+    item->index = -1;
+}
+
+PendingInterrupt *
+PendingQueue::RemoveFront()
+{
+    PendingInterrupt *item = Front();
+
+    RemoveAt(0);
+    return item;
+}
+
+void PendingQueue::Remove(PendingInterrupt *item)
+{
+    RemoveAt(item->index);
+}
+
+//----------------------------------------------------------------------
+// PendingQueue::Apply
+//	Apply a function to every interrupt on the queue, in heap order.
+//----------------------------------------------------------------------
+
+void PendingQueue::Apply(void (*func)(PendingInterrupt *)) const
+{
+    for (int i = 0; i < numInQueue; i++)
     {
-        return 0;
+        (*func)(heap[i]);
+    }
+}
+
+//----------------------------------------------------------------------
+// PendingQueue::SanityCheck
+//	Check that every interrupt knows where it is, and isn't due
+//	before its parent.
+//----------------------------------------------------------------------
+
+void PendingQueue::SanityCheck() const
+{
+    ASSERT(numInQueue >= 0 && numInQueue <= size);
+    for (int i = 0; i < numInQueue; i++)
+    {
+        ASSERT(heap[i]->index == i);
+        ASSERT(i == 0 || !Before(heap[i], heap[(i - 1) / 4]));
     }
 }
 
@@ -81,9 +265,10 @@ PendingCompare(PendingInterrupt *x, PendingInterrupt *y)
 Interrupt::Interrupt()
 {
     level = IntOff;
-    pending = new SortedList<PendingInterrupt *>(PendingCompare);
+    pending = new PendingQueue();
     inHandler = FALSE;
     yieldOnReturn = FALSE;
+    preempting = FALSE;
     status = SystemMode;
 }
 
@@ -94,11 +279,7 @@ Interrupt::Interrupt()
 
 Interrupt::~Interrupt()
 {
-    while (!pending->IsEmpty())
-    {
-        delete pending->RemoveFront();
-    }
-    delete pending;
+    delete pending; // along with anything still on it
 }
 
 //----------------------------------------------------------------------
@@ -183,6 +364,7 @@ void Interrupt::OneTick()
         // for a context switch, ok to do it now
         yieldOnReturn = FALSE;
         status = SystemMode; // yield is a kernel routine
+        preempting = TRUE;   // not the thread's own idea
         kernel->currentThread->Yield();
         status = oldStatus;
     }
@@ -246,6 +428,19 @@ void Interrupt::Halt()
 {
     cout << "Machine halting!\n\n";
     kernel->stats->Print();
+    kernel->scheduler->PrintStats();
+    Slab::PrintAll();
+#ifdef SYNCH_PROFILE
+    SynchProfile::PrintAll();
+#endif
+#ifdef USER_PROGRAM
+    AddrSpace::PrintMergeStats();
+#endif
+#ifdef FILESYS
+    kernel->machine->PrintSwapStats();
+    if (kernel->swapCache != NULL)
+        kernel->swapCache->Print();
+#endif
     delete kernel; // Never returns.
 }
 
@@ -254,7 +449,7 @@ void Interrupt::Halt()
 // 	Arrange for the CPU to be interrupted when simulated time
 //	reaches "now + when".
 //
-//	Implementation: just put it on a sorted list.
+//	Implementation: just put it on the pending queue.
 //
 //	NOTE: the Nachos kernel should not call this routine directly.
 //	Instead, it is only called by the hardware device simulators.
@@ -263,8 +458,13 @@ void Interrupt::Halt()
 //	"fromNow" is how far in the future (in simulated time) the
 //		 interrupt is to occur
 //	"type" is the hardware device that generated the interrupt
+//
+//	Returns a handle that can be passed to Cancel or Reschedule,
+//	until the interrupt occurs (the handle is no good once the
+//	handler has been called) or is canceled.
 //----------------------------------------------------------------------
-void Interrupt::Schedule(CallBackObj *toCall, int fromNow, IntType type)
+PendingInterrupt *
+Interrupt::Schedule(CallBackObj *toCall, int fromNow, IntType type)
 {
     int when = kernel->stats->totalTicks + fromNow;
     PendingInterrupt *toOccur = new PendingInterrupt(toCall, when, type);
@@ -273,6 +473,44 @@ void Interrupt::Schedule(CallBackObj *toCall, int fromNow, IntType type)
     ASSERT(fromNow > 0);
 
     pending->Insert(toOccur);
+    return toOccur;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::Cancel
+// 	Unschedule an interrupt, so that it never occurs.  A device can
+//	do this when it is turned off, or when whatever it was waiting
+//	for has happened some other way, instead of leaving an
+//	interrupt on the queue only to ignore it when it occurs.
+//
+//	"toCancel" is the handle returned by Schedule; the interrupt
+//		must not have occurred yet
+//----------------------------------------------------------------------
+void Interrupt::Cancel(PendingInterrupt *toCancel)
+{
+    DEBUG(dbgInt, "Canceling interrupt handler the " << intTypeNames[toCancel->type] << " at time = " << toCancel->when);
+    pending->Remove(toCancel);
+    delete toCancel;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::Reschedule
+// 	Move an interrupt to a new time.  It goes after any other
+//	interrupts due at the same time, as if it had just been
+//	scheduled.
+//
+//	"toMove" is the handle returned by Schedule; the interrupt
+//		must not have occurred yet
+//	"fromNow" is how far in the future (in simulated time) the
+//		 interrupt is now to occur
+//----------------------------------------------------------------------
+void Interrupt::Reschedule(PendingInterrupt *toMove, int fromNow)
+{
+    ASSERT(fromNow > 0);
+    pending->Remove(toMove);
+    toMove->when = kernel->stats->totalTicks + fromNow;
+    DEBUG(dbgInt, "Rescheduling interrupt handler the " << intTypeNames[toMove->type] << " at time = " << toMove->when);
+    pending->Insert(toMove);
 }
 
 //----------------------------------------------------------------------
@@ -328,6 +566,7 @@ bool Interrupt::CheckIfDue(bool advanceClock)
     do
     {
         next = pending->RemoveFront();     // pull interrupt off list
+        stats->numInterrupts++;
         next->callOnInterrupt->CallBack(); // call the interrupt handler
         delete next;
     } while (!pending->IsEmpty() && (pending->Front()->when <= stats->totalTicks));
@@ -362,3 +601,61 @@ void Interrupt::DumpState()
     pending->Apply(PrintPending);
     cout << "\nEnd of pending interrupts\n";
 }
+
+//----------------------------------------------------------------------
+// PendingQueueBenchmark
+// 	Time the pending interrupt queue on the host, in three phases:
+//	schedule "numEvents" interrupts at random times (many of them due
+//	at the same time as another); fire each of them once, the way a
+//	device does, by taking it off the front and scheduling it again
+//	a little later; then fire them all, checking that they come out
+//	in order, and in the order they were scheduled when due at the
+//	same time.
+//
+//	The interrupts are never really delivered, and simulated time
+//	doesn't advance.
+//----------------------------------------------------------------------
+
+void PendingQueueBenchmark(int numEvents)
+{
+    PendingQueue *queue = new PendingQueue();
+    PendingInterrupt *item, *prev;
+    double start, inserted, checked, held, drained;
+
+    start = HostTime();
+    for (int i = 0; i < numEvents; i++)
+    {
+        queue->Insert(new PendingInterrupt(NULL, RandomNumber() % numEvents,
+                                           TimerInt));
+    }
+    inserted = HostTime();
+    queue->SanityCheck(); // not timed
+
+    checked = HostTime();
+    for (int i = 0; i < numEvents; i++)
+    {
+        item = queue->RemoveFront();
+        item->when += 1 + RandomNumber() % 1000;
+        queue->Insert(item);
+    }
+    held = HostTime();
+
+    prev = NULL;
+    while (!queue->IsEmpty())
+    {
+        item = queue->RemoveFront();
+        ASSERT(prev == NULL || prev->when < item->when ||
+               (prev->when == item->when && prev->order < item->order));
+        delete prev;
+        prev = item;
+    }
+    delete prev;
+    drained = HostTime();
+    delete queue;
+
+    cout << "Pending queue benchmark: " << numEvents << " events, "
+         << (int)((inserted - start) * 1e9 / numEvents) << " ns per schedule, "
+         << (int)((held - checked) * 1e9 / numEvents)
+         << " ns per fire and reschedule, "
+         << (int)((drained - held) * 1e9 / numEvents) << " ns per fire\n";
+}
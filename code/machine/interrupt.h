@@ -68,6 +68,64 @@ class PendingInterrupt {
     
     int when;			// When the interrupt is supposed to fire
     IntType type;		// for debugging
+    unsigned int order;		// when it was scheduled, relative to
+				// the others, to break ties
+    int index;			// where it is in the pending queue,
+				// -1 if it isn't on it
+
+    void *operator new(size_t size) { return slab.Alloc(); }
+    void operator delete(void *p) { slab.Free(p); }
+				// allocated from a slab, since there's
+				// one for every interrupt
+  private:
+    static Slab slab;
+};
+
+// The following class defines the queue of pending interrupts: a 4-ary
+// heap in an array, ordered by when the interrupts are to occur.
+// Interrupts due at the same time come out in the order they were
+// inserted, as they did when this was a sorted list.
+//
+// Finding the next interrupt is O(1), and inserting and removing one
+// is O(log n) -- usually less, since new interrupts tend to be due
+// after the ones already waiting.  Each interrupt remembers where it is
+// in the heap.
+
+class PendingQueue {
+  public:
+    PendingQueue();		// initialize an empty queue
+    ~PendingQueue();		// de-allocate the queue
+
+    void Insert(PendingInterrupt *item);
+				// put an interrupt on the queue
+    PendingInterrupt *Front() { ASSERT(!IsEmpty()); return heap[0]; }
+				// the next interrupt to occur
+    PendingInterrupt *RemoveFront();
+				// take the next interrupt off the queue
+    void Remove(PendingInterrupt *item);
+				// take any interrupt off the queue
+    bool IsEmpty() { return (numInQueue == 0); }
+    int NumInQueue() { return numInQueue; }
+    void Apply(void (*f)(PendingInterrupt *)) const;
+				// apply function to every interrupt on
+				// the queue, in no particular order
+
+    void SanityCheck() const;	// has the queue been corrupted?
+
+  private:
+    PendingInterrupt **heap;	// heap[0] is due first; the children
+				// of heap[i] are heap[4i+1..4i+4]
+    int numInQueue;		// number of interrupts in the queue
+    int size;			// number of slots allocated
+    unsigned int nextOrder;	// stamp for the next interrupt inserted
+
+    bool Before(PendingInterrupt *x, PendingInterrupt *y) const;
+				// is x due before y?
+    void Place(int i, PendingInterrupt *item);
+				// put item in heap[i]
+    void SiftUp(int i);		// restore the heap property after
+    void SiftDown(int i);	//   heap[i] got earlier/later
+    void RemoveAt(int i);	// remove heap[i]
 };
 
 // The following class defines the data structures for the simulation
@@ -98,6 +156,12 @@ class Interrupt {
     
     void YieldOnReturn();	// cause a context switch on return 
 				// from an interrupt handler
+    bool isInHandler() { return inHandler; }
+				// are we running an interrupt handler?
+    bool TakePreemption() { bool p = preempting; preempting = FALSE;
+			    return p; }
+				// is the thread yielding because the
+				// timer told it to?  Only asks once.
 
     MachineStatus getStatus() { return status; } 
     void setStatus(MachineStatus st) { status = st; }
@@ -114,21 +178,30 @@ class Interrupt {
     // but they need to be public since they are called by the
     // hardware device simulators.
 
-    void Schedule(CallBackObj *callTo, int when, IntType type);
+    PendingInterrupt *Schedule(CallBackObj *callTo, int when, IntType type);
     				// Schedule an interrupt to occur
 				// at time "when".  This is called
     				// by the hardware device simulators.
+				// Returns a handle for the interrupt,
+				// good until it occurs or is canceled
+    void Cancel(PendingInterrupt *toCancel);
+				// Unschedule an interrupt that hasn't
+				// occurred yet
+    void Reschedule(PendingInterrupt *toMove, int when);
+				// Move an interrupt that hasn't occurred
+				// yet to "when" ticks from now
     
     void OneTick();       	// Advance simulated time
 
   private:
     IntStatus level;		// are interrupts enabled or disabled?
-    SortedList<PendingInterrupt *> *pending;		
-    				// the list of interrupts scheduled
+    PendingQueue *pending;	// the queue of interrupts scheduled
 				// to occur in the future
     bool inHandler;		// TRUE if we are running an interrupt handler
     bool yieldOnReturn; 	// TRUE if we are to context switch
 				// on return from the interrupt handler
+    bool preempting;		// TRUE while making the thread yield
+				// on return from the handler
     MachineStatus status;	// idle, kernel mode, user mode
 
     // these functions are internal to the interrupt simulation code
@@ -141,4 +214,7 @@ class Interrupt {
 			IntStatus now); // simulated time
 };
 
+// time scheduling and firing many interrupts
+extern void PendingQueueBenchmark(int numEvents);
+
 #endif // INTERRRUPT_H
@@ -77,6 +77,12 @@ Machine::Machine(bool debug, SwapType type)
     pageTable = NULL;
 #endif
 
+    numSwapReads = numSwapWrites = 0;
+    swapPagesRead = swapPagesWritten = 0;
+    swapReadTicks = swapWriteTicks = 0;
+    swapWrites = new List<int>;
+    swapWriteWaiters = new List<Thread *>;
+
     singleStep = debug;
     CheckEndian();
 }
@@ -91,6 +97,8 @@ Machine::~Machine()
     delete[] mainMemory;
     if (tlb != NULL)
         delete[] tlb;
+    delete swapWrites;
+    delete swapWriteWaiters;
 }
 
 //----------------------------------------------------------------------
@@ -25,6 +25,7 @@
 #include "copyright.h"
 #include "utility.h"
 #include "translate.h"
+#include "list.h"
 
 // Definitions related to the size, and format of user memory
 
@@ -87,6 +88,16 @@ enum ExceptionType
 
 class Instruction;
 class Interrupt;
+class AddrSpace;
+class Thread;
+
+// Victim search tiers used by page replacement (see Machine::chooseVictim)
+enum VictimTier {
+    SuspendedTier, // frames of processes suspended by load control
+    OverQuotaTier, // frames of processes holding more than their quota
+    LocalTier,     // frames of the faulting process
+    GlobalTier     // any frame
+};
 
 enum class SwapType {
     FIFO,
@@ -145,9 +156,30 @@ public:
 
     SwapType swapType; // default swap type is FIFO
     void swapPage(SwapType strategy, int virtAddr);
+    void copyOnWrite(int virtAddr); // write to a merged page
+    void handlePageFault(int virtAddr); // bring in the page at virtAddr
+
+    int CopyFromUser(int userAddr, char *buffer, int size);
+    int CopyToUser(int userAddr, char *buffer, int size);
+                // copy a buffer between user and kernel memory;
+                // return the number of bytes copied, or -1 if the
+                // user address range is invalid
+    int CopyStringFromUser(int userAddr, char *buffer, int maxSize);
+                // copy a null-terminated string of at most maxSize
+                // bytes (including the null) into the kernel; return
+                // its length, or -1 if invalid or too long
     
     bool ReadMem(int addr, int size, int *value);
 
+    void SwapIODone(bool writing, int pages, int ticks);
+                // account for a swap request to the disk
+    void StartSwapWrite(int sector, int count);
+    void EndSwapWrite(int sector, int count);
+                // mark a run of swap sectors as being written to
+                // the disk, so that faults on them wait for the write
+    int SwapTicksPerPage(); // average swap I/O time per page
+    void PrintSwapStats();  // print swap I/O statistics
+
 private:
     // Routines internal to the machine simulation -- DO NOT call these directly
     void DelayedLoad(int nextReg, int nextVal);
@@ -169,7 +201,21 @@ private:
     // and return an exception code if the
     // translation couldn't be completed.
 
-    unsigned int calcLruPage();
+    int chooseVictim(SwapType strategy, AddrSpace *space);
+    bool isVictimCandidate(int frame, int tier, AddrSpace *space);
+    int calcFifoPage(int tier, AddrSpace *space);
+    int calcLruPage(int tier, AddrSpace *space);
+
+    int getFreeFrame(SwapType strategy, AddrSpace *space);
+    int pinUserPage(int vpn, bool writing);
+    int copyUser(int userAddr, char *buffer, int size, bool writing);
+    void swapOut(AddrSpace *owner, int vpn);          // swap out a cluster of pages
+    void swapOutShared(int frame);                    // swap out a merged page
+    void swapIn(AddrSpace *space, int vpn, int frame); // swap in (and prefetch) pages
+    void writeSwap(int sector, int count, char *data);
+    void readSwap(int sector, int count, char *data);
+    void swapIO(bool writing, int sector, int count, char *data);
+    void waitForSwapWrites(int sector, int count);
 
     void RaiseException(ExceptionType which, int badVAddr);
     // Trap to the Nachos kernel, because of a
@@ -191,6 +237,12 @@ private:
 
 
     unsigned int fifoSwapPage = 0;
+
+    int numSwapReads, numSwapWrites;         // swap requests to the disk
+    int swapPagesRead, swapPagesWritten;     // pages they transferred
+    int swapReadTicks, swapWriteTicks;       // time they took
+    List<int> *swapWrites;                   // swap sectors being written
+    List<Thread *> *swapWriteWaiters;        // faults waiting for them
     // unsigned int lruSwapPage = 0; // 不需要
 };
 
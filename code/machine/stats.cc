@@ -22,6 +22,34 @@ Statistics::Statistics()
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numInterrupts = 0;
+    numJobs = numDeadlineMisses = 0;
+    for (int i = 0; i < NumLatenessBuckets; i++)
+        lateness[i] = 0;
+}
+
+//----------------------------------------------------------------------
+// Statistics::RecordLateness
+// 	Count a periodic real-time job that has just finished.
+//
+//	"ticks" is how long after its deadline it finished; zero or
+//	less if it made its deadline.
+//----------------------------------------------------------------------
+
+void Statistics::RecordLateness(int ticks)
+{
+    int bucket = 0;
+
+    numJobs++;
+    if (ticks > 0) {
+        numDeadlineMisses++;
+        for (int limit = 10; bucket < NumLatenessBuckets - 1; limit *= 10) {
+            bucket++;
+            if (ticks <= limit)
+                break;
+        }
+    }
+    lateness[bucket]++;
 }
 
 //----------------------------------------------------------------------
@@ -41,4 +69,17 @@ void Statistics::Print()
     cout << "Paging: faults " << numPageFaults << "\n";
     cout << "Network I/O: packets received " << numPacketsRecvd;
     cout << ", sent " << numPacketsSent << "\n";
+    cout << "Interrupts: " << numInterrupts << "\n";
+    if (numJobs > 0) {
+        cout << "Real-time jobs: " << numJobs << ", deadline misses "
+             << numDeadlineMisses << "\n";
+        cout << "Lateness: on time " << lateness[0];
+        for (int i = 1, limit = 10; i < NumLatenessBuckets; i++, limit *= 10) {
+            if (i < NumLatenessBuckets - 1)
+                cout << ", <=" << limit << " " << lateness[i];
+            else
+                cout << ", >" << limit / 10 << " " << lateness[i];
+        }
+        cout << " (ticks late)\n";
+    }
 }
@@ -13,6 +13,10 @@
 
 #include "copyright.h"
 
+// Lateness of real-time jobs is kept as a histogram: on time, then
+// up to 10, 100, 1000, 10000 ticks late, then more than that.
+const int NumLatenessBuckets = 6;
+
 // The following class defines the statistics that are to be kept
 // about Nachos behavior -- how much time (ticks) elapsed, how
 // many user instructions executed, etc.
@@ -36,9 +40,15 @@ public:
     int numPageFaults;          // number of virtual memory page faults
     int numPacketsSent;         // number of packets sent over the network
     int numPacketsRecvd;        // number of packets received over the network
+    int numInterrupts;          // number of interrupt handlers called
+    int numJobs;                // number of periodic real-time jobs done
+    int numDeadlineMisses;      // number of them that finished late
+    int lateness[NumLatenessBuckets]; // how late they were
 
     Statistics(); // initialize everything to zero
 
+    void RecordLateness(int ticks); // a real-time job finished "ticks"
+                                    // after its deadline (< 0 if early)
     void Print(); // print collected statistics
 };
 
@@ -40,9 +40,27 @@ Timer::Timer(bool doRandom, CallBackObj *toCall)
     randomize = doRandom;
     callPeriodically = toCall;
     disable = FALSE;
+    next = NULL;
     SetInterrupt();
 }
 
+//----------------------------------------------------------------------
+// Timer::Disable
+//      Turn the timer device off.  If we are not in the middle of
+//	our own interrupt, cancel the next one, instead of letting it
+//	occur just to be ignored.
+//----------------------------------------------------------------------
+
+void
+Timer::Disable()
+{
+    disable = TRUE;
+    if (next != NULL) {
+	kernel->interrupt->Cancel(next);
+	next = NULL;
+    }
+}
+
 //----------------------------------------------------------------------
 // Timer::CallBack
 //      Routine called when interrupt is generated by the hardware 
@@ -52,6 +70,8 @@ Timer::Timer(bool doRandom, CallBackObj *toCall)
 void 
 Timer::CallBack() 
 {
+    next = NULL;	// it just happened
+    
     // invoke the Nachos interrupt handler for this device
     callPeriodically->CallBack();
     
@@ -76,6 +96,6 @@ Timer::SetInterrupt()
 	     delay = 1 + (RandomNumber() % (TimerTicks * 2));
         }
        // schedule the next timer device interrupt
-       kernel->interrupt->Schedule(this, delay, TimerInt);
+       next = kernel->interrupt->Schedule(this, delay, TimerInt);
     }
 }
@@ -24,6 +24,8 @@
 #include "utility.h"
 #include "callback.h"
 
+class PendingInterrupt;
+
 // The following class defines a hardware timer. 
 class Timer : public CallBackObj {
   public:
@@ -32,8 +34,7 @@ class Timer : public CallBackObj {
 				// every time slice.
     virtual ~Timer() {}
     
-    void Disable() { disable = TRUE; }
-    				// Turn timer device off, so it doesn't
+    void Disable();		// Turn timer device off, so it doesn't
 				// generate any more interrupts.
 
   private:
@@ -41,6 +42,8 @@ class Timer : public CallBackObj {
     CallBackObj *callPeriodically; // call this every TimerTicks time units 
     bool disable;		// turn off the timer device after next
     				// interrupt.
+    PendingInterrupt *next;	// the next interrupt we've scheduled,
+				// NULL if none
     
     void CallBack();		// called internally when the hardware
 				// timer generates an interrupt
@@ -294,67 +294,638 @@ void Machine::swapPage(SwapType strategy, int virtAddr)
     // 根據 strategy 選擇使用 FIFO 或 LRU 進行 swap page
 
     int vpn = virtAddr / PageSize;
-    int swapPage = -1;
-    if (strategy == SwapType::FIFO)
+    AddrSpace *space = kernel->currentThread->space;
+    TranslationEntry *entry = &pageTable[vpn];
+
+    // 頁面仍在記憶體中，只是被 load control 暫時 unmap 了 (soft fault)，不需要 I/O
+    if (space->IsResident(vpn))
     {
-        // 正常狀況 FIFO 不會出問題 但 swap 過程失敗會讓策略非完全的 FIFO
-        swapPage = fifoSwapPage;
-        // 更新 kernel->currentThread->fifoSwapPage
-        fifoSwapPage = (fifoSwapPage + 1) % NumPhysPages;
+        entry->valid = true;
+        return;
     }
-    else if (strategy == SwapType::LRU)
+
+    if (strategy != SwapType::FIFO && strategy != SwapType::LRU)
     {
-        // 找尋最久未使用的 page
-        swapPage = calcLruPage();
+        std::cout << "Invalid swap strategy" << std::endl;
+        exit(-8877);
+    }
+    // std::cout << "PageFaultException" << std::endl;
+    int swapPage = getFreeFrame(strategy, space);
+
+    // 再把 swap 中的 page (和它附近的 page) 存到 memory 中
+    swapIn(space, vpn, swapPage);
+
+    std::cout << "page " << swapPage << " swapped" << std::endl;
+}
+
+//----------------------------------------------------------------------
+// Machine::handlePageFault
+// 	Bring the page containing "virtAddr" of the current address space
+//	into memory, for a PageFaultException raised by the user program
+//	or by the kernel touching user memory.
+//----------------------------------------------------------------------
+
+void Machine::handlePageFault(int virtAddr)
+{
+    kernel->stats->numPageFaults++;
+    cout << "page fault" << endl;
+    kernel->currentThread->space->PageFaulted(); // may block under load control
+    swapPage(swapType, virtAddr);
+}
+
+//----------------------------------------------------------------------
+// Machine::CopyFromUser, Machine::CopyToUser
+// 	Copy "size" bytes between virtual address "userAddr" of the current
+//	address space and the kernel buffer "buffer".  Rather than going
+//	through ReadMem/WriteMem a word at a time, each user page is
+//	translated once, paged in (or copied, if merged and we are writing
+//	to it) if need be, and copied as a whole chunk out of mainMemory.
+//
+//	The pages are pinned from when they are translated until the whole
+//	copy is done, so that a page fault on a later page can't evict an
+//	earlier one.  Callers should copy through a bounded kernel buffer,
+//	so that only a couple of pages are pinned at a time.
+//
+//	Returns the number of bytes copied, or -1 (having copied nothing)
+//	if the user address range is outside the address space.
+//----------------------------------------------------------------------
+
+int Machine::CopyFromUser(int userAddr, char *buffer, int size)
+{
+    return copyUser(userAddr, buffer, size, FALSE);
+}
+
+int Machine::CopyToUser(int userAddr, char *buffer, int size)
+{
+    return copyUser(userAddr, buffer, size, TRUE);
+}
+
+int Machine::copyUser(int userAddr, char *buffer, int size, bool writing)
+{
+    unsigned int limit = pageTableSize * PageSize;
+    int firstPage, numPages, copied = 0;
+    int *frames;
+
+    if (userAddr < 0 || size < 0 || (unsigned int)userAddr > limit ||
+        (unsigned int)size > limit - userAddr)
+    {
+        DEBUG(dbgAddr, "Bad user buffer " << userAddr << ", size " << size);
+        return -1;
+    }
+    if (size == 0)
+        return 0;
+
+    firstPage = userAddr / PageSize;
+    numPages = (userAddr + size - 1) / PageSize - firstPage + 1;
+    frames = new int[numPages];
+
+    for (int i = 0; i < numPages; i++)
+    {
+        int offset = (i == 0) ? userAddr % PageSize : 0;
+        int chunk = PageSize - offset;
+        if (chunk > size - copied)
+            chunk = size - copied;
+
+        frames[i] = pinUserPage(firstPage + i, writing);
+        char *physical = &mainMemory[frames[i] * PageSize + offset];
+        if (writing)
+            memcpy(physical, buffer + copied, chunk);
+        else
+            memcpy(buffer + copied, physical, chunk);
+        copied += chunk;
+    }
+    for (int i = 0; i < numPages; i++)
+        AddrSpace::UnpinFrame(frames[i]);
+    delete [] frames;
+
+    ASSERT(copied == size);
+    return copied;
+}
+
+//----------------------------------------------------------------------
+// Machine::CopyStringFromUser
+// 	Copy the null-terminated string at "userAddr" into "buffer", which
+//	holds "maxSize" bytes, a page at a time.  Returns the length of the
+//	string, or -1 if it runs off the address space or doesn't fit.
+//----------------------------------------------------------------------
+
+int Machine::CopyStringFromUser(int userAddr, char *buffer, int maxSize)
+{
+    int copied = 0;
+
+    if (userAddr < 0)
+        return -1;
+
+    while (copied < maxSize)
+    {
+        int addr = userAddr + copied;
+        int vpn = addr / PageSize;
+        int offset = addr % PageSize;
+        int chunk = PageSize - offset;
+        if ((unsigned int)vpn >= pageTableSize)
+            return -1;
+        if (chunk > maxSize - copied)
+            chunk = maxSize - copied;
+
+        int frame = pinUserPage(vpn, FALSE);
+        char *physical = &mainMemory[frame * PageSize + offset];
+        char *end = (char *)memchr(physical, '\0', chunk);
+        if (end != NULL)
+            chunk = end - physical + 1;
+        memcpy(buffer + copied, physical, chunk);
+        AddrSpace::UnpinFrame(frame);
+        copied += chunk;
+        if (end != NULL)
+            return copied - 1;
+    }
+    DEBUG(dbgAddr, "User string at " << userAddr << " longer than " << maxSize);
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// Machine::pinUserPage
+// 	Make page "vpn" of the current address space resident (and, if
+//	"writing", private and writable), mark it used, and pin it.
+//	Returns the physical page.  Anything we wait for here can change
+//	the page table entry, so re-check it after each step.
+//----------------------------------------------------------------------
+
+int Machine::pinUserPage(int vpn, bool writing)
+{
+    TranslationEntry *entry = &pageTable[vpn];
+
+    for (;;)
+    {
+        if (!entry->valid)
+            handlePageFault(vpn * PageSize);
+        else if (writing && entry->readOnly)
+            copyOnWrite(vpn * PageSize);
+        else
+            break;
+    }
+
+    entry->use = TRUE;
+    entry->lastUsedTime = kernel->stats->totalTicks;
+    if (writing)
+        entry->dirty = TRUE;
+    AddrSpace::PinFrame(entry->physicalPage);
+    return entry->physicalPage;
+}
+
+//----------------------------------------------------------------------
+// Machine::getFreeFrame
+// 	Return a free physical page for "space", swapping out victims
+//	until there is one.  The caller must claim it before blocking.
+//----------------------------------------------------------------------
+
+int Machine::getFreeFrame(SwapType strategy, AddrSpace *space)
+{
+    int swapPage = chooseVictim(strategy, space);
+
+    // 沒有空的 frame 時，先把 victim (和它附近的 page) 存到 swap，之後對它的 fault 才一定讀得到新的內容
+    // 寫入期間空出來的 frame 可能被別的 thread 拿走，所以寫完要重新選一次
+    while (AddrSpace::usedPhyPage[swapPage])
+    {
+        TranslationEntry *victimEntry = AddrSpace::usedPhyPageEntry[swapPage]; // 取得 victimEntry (合併的 page 則為 NULL)
+        if (victimEntry == NULL)
+            swapOutShared(swapPage);
+        else
+            swapOut(AddrSpace::usedPhyPageSpace[swapPage], victimEntry->virtualPage);
+        swapPage = chooseVictim(strategy, space);
+    }
+    return swapPage;
+}
+
+//----------------------------------------------------------------------
+// Machine::copyOnWrite
+// 	Handle a write to a merged (read-only) page: give the current
+//	address space its own copy of the page.  If the other sharers
+//	have all gone away while we waited for a free physical page,
+//	the merged page has already been handed over to us.
+//----------------------------------------------------------------------
+
+void Machine::copyOnWrite(int virtAddr)
+{
+    int vpn = virtAddr / PageSize;
+    AddrSpace *space = kernel->currentThread->space;
+    int shared = pageTable[vpn].physicalPage;
+    int copy;
+
+    ASSERT(space->IsShared(vpn));
+    AddrSpace::PinFrame(shared); // 等待 free frame 期間不能被換出
+    copy = getFreeFrame(swapType, space);
+    AddrSpace::UnpinFrame(shared);
+
+    if (!space->IsShared(vpn))
+        return;
+    memcpy(&(mainMemory[copy * PageSize]), &(mainMemory[shared * PageSize]), PageSize);
+    space->BreakSharing(vpn, copy);
+}
+
+//----------------------------------------------------------------------
+// Machine::swapOut
+// 	Swap out page "vpn" of address space "owner", together with the
+//	neighbouring pages that AddrSpace::EvictionCluster picks, in a
+//	single write to their (consecutive) swap sectors.  All of their
+//	physical pages become free.
+//
+//	Room is made in the swap cache first, while the pages are still
+//	mapped, since that may block; from when the pages are unmapped
+//	until they are all in the cache or marked as being written (see
+//	StartSwapWrite), nothing may block, or a fault on one of them
+//	would read stale data.  If
+//	we did have to wait for room, the victim may have been referenced
+//	or freed in the meantime, so we swap nothing out, and let the
+//	caller choose again.
+//----------------------------------------------------------------------
+
+void Machine::swapOut(AddrSpace *owner, int vpn)
+{
+    int first;
+    int count = owner->EvictionCluster(vpn, &first);
+    char *buffer;
+
+    if (kernel->swapCache != NULL && kernel->swapCache->Reserve(count))
+        return;
+    buffer = new char[count * PageSize];
+    for (int i = 0; i < count; i++)
+    {
+        TranslationEntry *victimEntry = &owner->pageTable[first + i];
+        int frame = victimEntry->physicalPage;
+
+        victimEntry->valid = false; // 把 victimEntry 的 valid 設為 false，表示這個 page 已經被 swap 出去了
+        memcpy(buffer + i * PageSize, &(mainMemory[frame * PageSize]), PageSize);
+        AddrSpace::ReleaseFrame(frame);
+        victimEntry->diskPage = owner->SwapSector(first + i);
+    }
+    writeSwap(owner->SwapSector(first), count, buffer);
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// Machine::swapOutShared
+// 	Swap out a merged physical page: write its contents to the swap
+//	sector of every page that shares it.  As in swapOut, room is
+//	made in the swap cache before the page is unmapped.
+//----------------------------------------------------------------------
+
+void Machine::swapOutShared(int frame)
+{
+    char *buffer;
+    List<SharedPage *> *sharers;
+
+    if (kernel->swapCache != NULL &&
+        kernel->swapCache->Reserve(AddrSpace::usedPhyPageSharers[frame]->NumInList()))
+        return;
+    buffer = new char[PageSize];
+    memcpy(buffer, &(mainMemory[frame * PageSize]), PageSize);
+    sharers = AddrSpace::TakeSharers(frame);
+    while (!sharers->IsEmpty())
+    {
+        SharedPage *page = sharers->RemoveFront();
+        writeSwap(page->space->SwapSector(page->vpn), 1, buffer);
+        delete page;
+    }
+    delete sharers;
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// Machine::swapIn
+// 	Swap in page "vpn" of address space "space" into physical page
+//	"frame", prefetching the neighbouring pages that
+//	AddrSpace::PrefetchCluster picks into free physical pages, with
+//	a single read of their (consecutive) swap sectors.
+//
+//	The physical pages are claimed, and pinned, before the read, so
+//	that no other thread takes them while we wait for the disk.
+//----------------------------------------------------------------------
+
+void Machine::swapIn(AddrSpace *space, int vpn, int frame)
+{
+    int first;
+    int count = space->PrefetchCluster(vpn, &first);
+    char *buffer = new char[count * PageSize];
+    int *frames = new int[count];
+
+    space->pageTable[vpn].physicalPage = frame;
+    AddrSpace::AssignFrame(frame, space, &space->pageTable[vpn]);
+    for (int i = 0, next = 0; i < count; i++)
+    {
+        TranslationEntry *entry = &space->pageTable[first + i];
+
+        if (first + i != vpn)
+        {
+            while (AddrSpace::usedPhyPage[next])
+                next++;
+            entry->physicalPage = next;
+            AddrSpace::AssignFrame(next, space, entry);
+        }
+        frames[i] = entry->physicalPage;
+        AddrSpace::PinFrame(frames[i]);
+    }
+
+    readSwap(space->SwapSector(first), count, buffer);
+
+    for (int i = 0; i < count; i++)
+    {
+        TranslationEntry *entry = &space->pageTable[first + i];
+
+        memcpy(&(mainMemory[frames[i] * PageSize]), buffer + i * PageSize, PageSize);
+        AddrSpace::UnpinFrame(frames[i]);
+        // 更新 pageTable (I/O 期間若被 load control 暫停，就等下次 fault 再 map)
+        entry->valid = !space->IsSuspended();
+        if (first + i != vpn)
+        {
+            entry->use = false; // 預先讀入的 page 還沒被用過
+            entry->lastUsedTime = kernel->stats->totalTicks;
+        }
+    }
+    if (count > 1)
+    {
+        DEBUG(dbgPaging, "Prefetched pages " << first << ".." << first + count - 1
+                         << " with page " << vpn);
+    }
+    delete [] frames;
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// Machine::writeSwap, Machine::readSwap
+// 	Move "count" pages between "data" and the consecutive swap sectors
+//	starting at "sector".  The compressed swap cache, if there is one,
+//	gets the first chance to handle each page; the rest come from the
+//	disk, one request for each run of consecutive sectors.
+//
+//	When writing, every page the cache doesn't take goes out in one
+//	request.  Cached pages in the middle of the request are written
+//	too; that does no harm, since the cached copy is the same, and
+//	is the one that is read.
+//
+//	When reading, we first wait for any write to the sectors that is
+//	still in progress: until it reaches the disk, the disk is out of
+//	date, and a page we took from the cache could be swapped out and
+//	written again ahead of it.
+//----------------------------------------------------------------------
+
+void Machine::writeSwap(int sector, int count, char *data)
+{
+    SwapCache *cache = kernel->swapCache;
+    int lo = count, hi = -1; // pages that must go to the disk
+
+    for (int i = 0; i < count; i++)
+    {
+        if (cache == NULL || !cache->Store(sector + i, data + i * PageSize))
+        {
+            if (i < lo)
+                lo = i;
+            hi = i;
+        }
+    }
+    if (hi >= lo)
+        swapIO(TRUE, sector + lo, hi - lo + 1, data + lo * PageSize);
+}
+
+void Machine::readSwap(int sector, int count, char *data)
+{
+    SwapCache *cache = kernel->swapCache;
+    int run = 0; // pages just before page i that must come from the disk
+
+    waitForSwapWrites(sector, count);
+    for (int i = 0; i <= count; i++)
+    {
+        if (i < count && (cache == NULL || !cache->Load(sector + i, data + i * PageSize)))
+        {
+            run++;
+            continue;
+        }
+        if (run > 0)
+            swapIO(FALSE, sector + i - run, run, data + (i - run) * PageSize);
+        run = 0;
+    }
+}
+
+//----------------------------------------------------------------------
+// Machine::swapIO
+// 	Transfer a run of swap sectors to or from the disk, and account
+//	for how long it took.  The sectors are marked while they are
+//	written, since we may wait for the disk before the request is
+//	even issued.
+//----------------------------------------------------------------------
+
+void Machine::swapIO(bool writing, int sector, int count, char *data)
+{
+    int start = kernel->stats->totalTicks;
+
+    if (writing)
+    {
+        StartSwapWrite(sector, count);
+        kernel->synchDisk->WriteSectors(sector, count, data);
+        EndSwapWrite(sector, count);
+    }
+    else
+        kernel->synchDisk->ReadSectors(sector, count, data);
+    SwapIODone(writing, count, kernel->stats->totalTicks - start);
+}
+
+//----------------------------------------------------------------------
+// Machine::StartSwapWrite, Machine::EndSwapWrite
+// 	Mark the "count" swap sectors starting at "sector" as being
+//	written to the disk, and unmark them once the write is done,
+//	waking up the faults waiting for them.
+//
+//	A page must be marked before anything blocks once it has left
+//	both memory and the swap cache: a fault on it has to wait for
+//	the write, not read the old contents from the disk.
+//----------------------------------------------------------------------
+
+void Machine::StartSwapWrite(int sector, int count)
+{
+    for (int i = 0; i < count; i++)
+        swapWrites->Append(sector + i);
+}
+
+void Machine::EndSwapWrite(int sector, int count)
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    for (int i = 0; i < count; i++)
+        swapWrites->Remove(sector + i);
+    while (!swapWriteWaiters->IsEmpty())
+        kernel->scheduler->ReadyToRun(swapWriteWaiters->RemoveFront());
+    (void)kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Machine::waitForSwapWrites
+// 	Wait until none of the "count" swap sectors starting at "sector"
+//	is being written to the disk.
+//----------------------------------------------------------------------
+
+void Machine::waitForSwapWrites(int sector, int count)
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    for (int i = 0; i < count; i++)
+    {
+        while (swapWrites->IsInList(sector + i))
+        {
+            DEBUG(dbgPaging, "Waiting for the write of swap sector " << sector + i);
+            swapWriteWaiters->Append(kernel->currentThread);
+            kernel->currentThread->Sleep(FALSE);
+        }
+    }
+    (void)kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Machine::SwapIODone
+// 	Account for one swap request to the disk, of "pages" pages,
+//	that took "ticks" from when it was issued until it completed.
+//----------------------------------------------------------------------
+
+void Machine::SwapIODone(bool writing, int pages, int ticks)
+{
+    if (writing)
+    {
+        numSwapWrites++;
+        swapPagesWritten += pages;
+        swapWriteTicks += ticks;
     }
     else
     {
-        std::cout << "Invalid swap strategy" << std::endl;
-        exit(-8877);
+        numSwapReads++;
+        swapPagesRead += pages;
+        swapReadTicks += ticks;
     }
+}
 
-    // std::cout << "PageFaultException" << std::endl;
-    TranslationEntry *victimEntry = AddrSpace::usedPhyPageEntry[swapPage]; // 取得 victimEntry
+//----------------------------------------------------------------------
+// Machine::SwapTicksPerPage
+// 	Return the average swap I/O time per page so far, or 0 if no
+//	page has gone to or come from the disk yet.
+//----------------------------------------------------------------------
+
+int Machine::SwapTicksPerPage()
+{
+    int pages = swapPagesRead + swapPagesWritten;
 
-    victimEntry->valid = false;                  // 把 victimEntry 的 valid 設為 false，表示這個 page 已經被 swap 出去了
-    int swapPhyPage = victimEntry->physicalPage; // 取得 victimEntry 的 physicalPage，這是要被 swap 出去的 page
+    if (pages == 0)
+        return 0;
+    return (swapReadTicks + swapWriteTicks) / pages;
+}
 
-    // 創建一個 buffer，大小為 PageSize，要把 memory 中的一個 page 存到 buffer 中 (存起來)
-    char *tempBuffer = new char[PageSize];
-    memcpy(tempBuffer, &(mainMemory[swapPhyPage * PageSize]), PageSize);
+//----------------------------------------------------------------------
+// Machine::PrintSwapStats
+// 	Print the swap I/O that went to the disk, and its average latency
+//	per request and per page.
+//----------------------------------------------------------------------
 
-    // 把 disk 中的一個 page 存到 memory 中
-    kernel->synchDisk->ReadSector(pageTable[vpn].diskPage, &(mainMemory[swapPhyPage * PageSize]));
+void Machine::PrintSwapStats()
+{
+    if (numSwapReads + numSwapWrites == 0)
+        return;
+
+    cout << "Swap I/O: cluster " << AddrSpace::clusterPages << " pages";
+    cout << ", reads " << swapPagesRead << " pages in " << numSwapReads << " requests";
+    if (numSwapReads > 0)
+        cout << " (" << swapReadTicks / numSwapReads << " ticks per request, "
+             << swapReadTicks / swapPagesRead << " per page)";
+    cout << ", writes " << swapPagesWritten << " pages in " << numSwapWrites << " requests";
+    if (numSwapWrites > 0)
+        cout << " (" << swapWriteTicks / numSwapWrites << " ticks per request, "
+             << swapWriteTicks / swapPagesWritten << " per page)";
+    cout << "\n";
+    cout << "Swap I/O: average latency " << SwapTicksPerPage() << " ticks per page\n";
+}
 
-    // 把 buffer 中的 page 存到 disk 中
-    if (victimEntry->diskPage == -1)
+//----------------------------------------------------------------------
+// Machine::chooseVictim
+// 	Pick the physical page to hold a page that "space" faulted on.
+//	A free frame is used if there is one.  Otherwise, with load
+//	control enabled, victims are searched for in order among:
+//		frames of suspended processes,
+//		frames of processes over their quota, if "space" is
+//		    under its own quota,
+//		frames of "space" itself (local replacement),
+//	before falling back on every frame (global replacement, which is
+//	the only tier without load control).  Within a tier, the FIFO
+//	or LRU strategy decides.  Merged pages are only chosen when
+//	nothing else is left.
+//----------------------------------------------------------------------
+
+int Machine::chooseVictim(SwapType strategy, AddrSpace *space)
+{
+    for (unsigned int i = 0; i < NumPhysPages; i++)
+        if (!AddrSpace::usedPhyPage[i])
+            return i;
+
+    for (int tier = AddrSpace::loadControl ? SuspendedTier : GlobalTier; tier <= GlobalTier; tier++)
     {
-        victimEntry->diskPage = kernel->synchDisk->numUsedSectors++;
+        if (tier == OverQuotaTier && !space->UnderQuota())
+            continue;
+        int victim = (strategy == SwapType::FIFO) ? calcFifoPage(tier, space) : calcLruPage(tier, space);
+        if (victim >= 0)
+            return victim;
     }
-    kernel->synchDisk->WriteSector(victimEntry->diskPage, tempBuffer);
+    for (unsigned int i = 0; i < NumPhysPages; i++)
+        if (AddrSpace::usedPhyPageSharers[i] != NULL && AddrSpace::usedPhyPagePins[i] == 0)
+            return i;
+    ASSERTNOTREACHED();
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// Machine::isVictimCandidate
+// 	Is physical page "frame" eligible for replacement in victim
+//	search tier "tier", on behalf of address space "space"?
+//----------------------------------------------------------------------
 
-    // 更新 pageTable
-    pageTable[vpn].valid = true;
-    pageTable[vpn].physicalPage = swapPhyPage;
+bool Machine::isVictimCandidate(int frame, int tier, AddrSpace *space)
+{
+    AddrSpace *owner = AddrSpace::usedPhyPageSpace[frame];
 
-    AddrSpace::usedPhyPageEntry[swapPage] = &pageTable[vpn];
-    std::cout << "page " << swapPage << " swapped" << std::endl;
+    if (AddrSpace::usedPhyPageEntry[frame] == nullptr || AddrSpace::usedPhyPagePins[frame] > 0)
+        return false;
+    switch (tier)
+    {
+    case SuspendedTier:
+        return owner != NULL && owner->IsSuspended();
+    case OverQuotaTier:
+        return owner != NULL && owner != space && owner->OverQuota();
+    case LocalTier:
+        return owner == space;
+    default:
+        return true;
+    }
+}
 
-    // 釋放 buffer
-    delete [] tempBuffer;
+int Machine::calcFifoPage(int tier, AddrSpace *space) {
+    // 正常狀況 FIFO 不會出問題 但 swap 過程失敗會讓策略非完全的 FIFO
+    for (unsigned int n = 0; n < NumPhysPages; n++)
+    {
+        int frame = (fifoSwapPage + n) % NumPhysPages;
+        if (isVictimCandidate(frame, tier, space))
+        {
+            // 更新 fifoSwapPage
+            fifoSwapPage = (frame + 1) % NumPhysPages;
+            return frame;
+        }
+    }
+    return -1;
 }
 
-unsigned int Machine::calcLruPage() {
+int Machine::calcLruPage(int tier, AddrSpace *space) {
     unsigned int leastRecentTime = INT_MAX;
-    unsigned int swapPage = 0;
-    // 預設 mainMemory 全都是有占用的因此沒有檢查是否有空的 page
-    for (int i = 0; i < NumPhysPages; i++)
+    int swapPage = -1;
+    // 找尋最久未使用的 page
+    for (unsigned int i = 0; i < NumPhysPages; i++)
     {
-        if (AddrSpace::usedPhyPageEntry[i] != nullptr && AddrSpace::usedPhyPageEntry[i]->lastUsedTime < leastRecentTime)
+        if (isVictimCandidate(i, tier, space) && (swapPage < 0 || AddrSpace::usedPhyPageEntry[i]->lastUsedTime < leastRecentTime))
         {
             leastRecentTime = AddrSpace::usedPhyPageEntry[i]->lastUsedTime;
             swapPage = i;
         }
     }
     return swapPage;
-}
\ No newline at end of file
+}
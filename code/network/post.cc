@@ -29,6 +29,8 @@
 //	"data" -- payload data
 //----------------------------------------------------------------------
 
+Slab Mail::slab = { "Mail", sizeof(Mail) };
+
 Mail::Mail(PacketHeader pktH, MailHeader mailH, char *msgData)
 {
     ASSERT(mailH.length <= MaxMailSize);
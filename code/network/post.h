@@ -70,6 +70,13 @@ class Mail {
      PacketHeader pktHdr;	// Header appended by Network
      MailHeader mailHdr;	// Header appended by PostOffice
      char data[MaxMailSize];	// Payload -- message data
+
+     void *operator new(size_t size) { return slab.Alloc(); }
+     void operator delete(void *p) { slab.Free(p); }
+				// allocated from a slab, since there's
+				// one for every message received
+  private:
+     static Slab slab;
 };
 
 // The following class defines a single mailbox, or temporary storage
@@ -0,0 +1,9 @@
+#include "syscall.h"
+main()
+	{
+		int	n;
+		for (n=5;n>0;n--) {
+			PrintInt(n);
+			Sleep(1000);	// let the other programs run
+		}
+	}
@@ -18,11 +18,20 @@
 //
 //      "doRandom" -- if true, arrange for the hardware interrupts to 
 //		occur at random, instead of fixed, intervals.
+//	"tickless" -- if true, don't use the timer; the scheduler
+//		programs a quantum only when it is needed.
 //----------------------------------------------------------------------
 
-Alarm::Alarm(bool doRandom)
+Alarm::Alarm(bool doRandom, bool tickless)
 {
-    timer = new Timer(doRandom, this);
+#ifdef USER_PROGRAM
+    // working sets and duplicate pages are sampled on every timer
+    // interrupt, so they need the timer to keep going
+    if (AddrSpace::loadControl || AddrSpace::pageMerging)
+	tickless = FALSE;
+#endif
+    randomYield = doRandom && !tickless;
+    timer = tickless ? NULL : new Timer(doRandom, this);
 }
 
 //----------------------------------------------------------------------
@@ -50,18 +59,213 @@ void
 Alarm::CallBack() 
 {
     Interrupt *interrupt = kernel->interrupt;
-    MachineStatus status = interrupt->getStatus();
+    bool resumed = FALSE;
     
-    kernel->currentThread->setPriority(kernel->currentThread->getPriority() - 1);
-    if (status == IdleMode) {	// is it time to quit?
-        if (!interrupt->AnyFutureInterrupts()) {
+#ifdef USER_PROGRAM
+    resumed = AddrSpace::SampleWorkingSets();	// working sets, load control
+    AddrSpace::ScanForDuplicates();		// same-page merging
+#endif
+
+    Tick();
+    if (interrupt->getStatus() == IdleMode) {	// is it time to quit?
+        if (!resumed && !interrupt->AnyFutureInterrupts()) {
 	    timer->Disable();	// turn off the timer
 	}
-    } else {			// there's someone to preempt
-	if(kernel->scheduler->getSchedulerType() == RR ||
-            kernel->scheduler->getSchedulerType() == Priority ) {
+    }
+}
+
+//----------------------------------------------------------------------
+// Alarm::Tick
+//	Called on each timer interrupt, or, in tickless mode, at the end
+//	of each quantum.  Do the scheduler's periodic bookkeeping, and
+//	preempt the running thread if the scheduler wants us to.
+//
+//	RR, Priority, Stride and Lottery preempt a thread when its own
+//	quantum is up, whenever that is (see Scheduler::QuantumExpired);
+//	but with random time slicing, they switch on every timer
+//	interrupt, to shake out race conditions.
+//----------------------------------------------------------------------
+
+void
+Alarm::Tick()
+{
+    Interrupt *interrupt = kernel->interrupt;
+
+    kernel->scheduler->CheckBoost();		// MLFQ aging
+    kernel->scheduler->SampleFairness();
+    kernel->currentThread->setPriority(kernel->currentThread->getBasePriority() - 1);
+    if (interrupt->getStatus() != IdleMode) {	// there's someone to preempt
+	if (randomYield && (kernel->scheduler->getSchedulerType() == RR ||
+            kernel->scheduler->getSchedulerType() == Priority ||
+            kernel->scheduler->getSchedulerType() == Stride ||
+            kernel->scheduler->getSchedulerType() == Lottery)) {
+		interrupt->YieldOnReturn();	// -rs: switch at random times
+	} else if (kernel->scheduler->ShouldPreempt()) {	// SRTF, MLFQ
 		interrupt->YieldOnReturn();
 	}
     }
 }
 
+//----------------------------------------------------------------------
+// Alarm::WaitUntil, Alarm::SleepFor
+//	Put the current thread to sleep until simulated time "when", or
+//	for "ticks" ticks.  It is put back on the ready list by a timer
+//	interrupt once the time has come; meanwhile, other threads get
+//	the CPU.  If the time has already come, return right away.
+//----------------------------------------------------------------------
+
+void
+Alarm::WaitUntil(int when)
+{
+    IntStatus oldLevel;
+
+    if (when <= kernel->stats->totalTicks) {
+	return;
+    }
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    sleepQueue.Sleep(when);
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+void
+Alarm::SleepFor(int ticks)
+{
+    WaitUntil(kernel->stats->totalTicks + ticks);
+}
+
+//----------------------------------------------------------------------
+// SleepCompare
+//	Compare two sleeping threads by when they are to wake up.
+//----------------------------------------------------------------------
+
+static int
+SleepCompare(Thread *x, Thread *y)
+{
+    if (x->getWakeTime() < y->getWakeTime()) {
+	return -1;
+    } else if (x->getWakeTime() > y->getWakeTime()) {
+	return 1;
+    }
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// SleepQueue::SleepQueue, SleepQueue::~SleepQueue
+//	Initialize and de-allocate the queue of sleeping threads.
+//----------------------------------------------------------------------
+
+SleepQueue::SleepQueue()
+{
+    sleepers = new SortedLinkedList<Thread, &Thread::queueLink>(SleepCompare);
+    next = NULL;
+}
+
+SleepQueue::~SleepQueue()
+{
+    delete sleepers;
+}
+
+//----------------------------------------------------------------------
+// SleepQueue::Sleep
+//	Put the current thread to sleep until time "when", which must
+//	be in the future.  If it is to wake up before anyone else,
+//	move the interrupt up.
+//
+//	Interrupts must be disabled.
+//----------------------------------------------------------------------
+
+void
+SleepQueue::Sleep(int when)
+{
+    Thread *thread = kernel->currentThread;
+    int now = kernel->stats->totalTicks;
+
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+    ASSERT(when > now);
+    DEBUG(dbgThread, "Sleeping thread: " << thread->getName() << " until " << when);
+
+    thread->setWakeTime(when);
+    sleepers->Insert(thread);
+    if (next == NULL) {
+	next = kernel->interrupt->Schedule(this, when - now, TimerInt);
+    } else if (when < next->when) {
+	kernel->interrupt->Reschedule(next, when - now);
+    }
+    thread->Sleep(FALSE);
+}
+
+//----------------------------------------------------------------------
+// SleepQueue::CallBack
+//	Interrupt handler for the first sleeping thread's wake up time.
+//	Wake up everyone whose time has come, and schedule an interrupt
+//	for the next one to wake up, if any.
+//----------------------------------------------------------------------
+
+void
+SleepQueue::CallBack()
+{
+    int now = kernel->stats->totalTicks;
+
+    next = NULL;		// it just happened
+    while (!sleepers->IsEmpty() && sleepers->Front()->getWakeTime() <= now) {
+	kernel->scheduler->ReadyToRun(sleepers->RemoveFront());
+    }
+    if (!sleepers->IsEmpty()) {
+	next = kernel->interrupt->Schedule(this,
+			sleepers->Front()->getWakeTime() - now, TimerInt);
+    }
+}
+
+//----------------------------------------------------------------------
+// QuantumTimer::Start
+//	Arrange for the running thread to be preempted after "ticks"
+//	more ticks, replacing any earlier quantum.
+//----------------------------------------------------------------------
+
+void
+QuantumTimer::Start(int ticks)
+{
+    ASSERT(ticks > 0);
+    end = kernel->stats->totalTicks + ticks;
+    if (next == NULL) {
+	next = kernel->interrupt->Schedule(this, ticks, TimerInt);
+    } else if (next->when != end) {
+	kernel->interrupt->Reschedule(next, ticks);
+    }
+}
+
+//----------------------------------------------------------------------
+// QuantumTimer::Stop
+//	Forget about the current quantum, and cancel its interrupt.
+//----------------------------------------------------------------------
+
+void
+QuantumTimer::Stop()
+{
+    end = -1;
+    if (next != NULL) {
+	kernel->interrupt->Cancel(next);
+	next = NULL;
+    }
+}
+
+//----------------------------------------------------------------------
+// QuantumTimer::CallBack
+//	Interrupt handler for the end of a quantum.  Since the interrupt
+//	is moved whenever the quantum is, it only occurs when a quantum
+//	is really over -- unless the thread has given up the CPU and no
+//	one else is running, in which case there's nothing to do.
+//----------------------------------------------------------------------
+
+void
+QuantumTimer::CallBack()
+{
+    next = NULL;		// it just happened
+    ASSERT(end == kernel->stats->totalTicks);
+    end = -1;
+    if (kernel->interrupt->getStatus() == IdleMode) {
+	return;
+    }
+    kernel->scheduler->QuantumExpired();
+}
+
@@ -21,18 +21,86 @@
 #include "utility.h"
 #include "callback.h"
 #include "timer.h"
+#include "thread.h"
+
+// The following class defines a one-shot timer for the end of the
+// running thread's quantum, for schedulers (like MLFQ) whose quanta
+// aren't all TimerTicks long.  There is at most one interrupt pending,
+// always at the end of the current quantum: starting a new quantum
+// moves it there, and stopping the quantum cancels it, so when it
+// happens the quantum really is over.
+class QuantumTimer : public CallBackObj {
+  public:
+    QuantumTimer() { end = -1; next = NULL; }
+    
+    void Start(int ticks);	// interrupt the running thread "ticks"
+				// from now
+    void Stop();		// forget about the current quantum
+
+  private:
+    int end;			// when the current quantum is over,
+				// -1 if there isn't one
+    PendingInterrupt *next;	// the interrupt for the end of the
+				// quantum, NULL if there isn't one
+
+    void CallBack();		// called when the interrupt happens
+};
+
+// The following class defines the threads sleeping on the alarm clock,
+// in the order they are to wake up.  Only one interrupt is ever
+// scheduled, for the first of them; it is moved whenever a thread
+// goes to sleep in front of it.
+
+class SleepQueue : public CallBackObj {
+  public:
+    SleepQueue();
+    ~SleepQueue();
+
+    void Sleep(int when);	// put the current thread to sleep until
+				// time "when"
+    bool IsEmpty() { return sleepers->IsEmpty(); }
+
+  private:
+    SortedLinkedList<Thread, &Thread::queueLink> *sleepers;
+				// the sleeping threads, soonest first
+    PendingInterrupt *next;	// the interrupt for the first of them,
+				// NULL if there are none
+
+    void CallBack();		// wake up the threads whose time has come
+};
 
 // The following class defines a software alarm clock. 
+//
+// In "tickless" mode, the hardware timer isn't used at all.  Instead,
+// the scheduler starts a quantum only while there is some other thread
+// that could take the CPU away from the running one, and calls Tick
+// when it is over.  A thread that runs alone, or under a scheduler
+// that never preempts, then sees no timer interrupts at all.
 class Alarm : public CallBackObj {
   public:
-    Alarm(bool doRandomYield);	// Initialize the timer, and callback 
+    Alarm(bool doRandomYield, bool tickless);
+				// Initialize the timer, and callback 
 				// to "toCall" every time slice.
     ~Alarm() { delete timer; }
+
+    bool IsTickless() { return timer == NULL; }
+    void Tick();		// do what we do on each timer interrupt
     
-    void WaitUntil(int x);	// suspend execution until time > now + x
+    void WaitUntil(int when);	// suspend execution until time "when"
+    void SleepFor(int ticks);	// suspend execution for "ticks"
+
+    void StartQuantum(int ticks) { quantum.Start(ticks); }
+				// preempt the running thread once it
+				// has run for "ticks"
+    void StopQuantum() { quantum.Stop(); }
+				// let the running thread run on
 
   private:
     Timer *timer;		// the hardware timer device
+    bool randomYield;		// time-slice on every (randomly timed)
+				// timer interrupt
+    QuantumTimer quantum;	// end of the running thread's quantum
+    SleepQueue sleepQueue;	// threads waiting for their time to come
 
     void CallBack();		// called when the hardware
 				// timer generates an interrupt
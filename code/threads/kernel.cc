@@ -14,6 +14,7 @@
 #include "synchlist.h"
 #include "libtest.h"
 #include "elevatortest.h"
+#include "workload.h"
 #include "string.h"
 
 //----------------------------------------------------------------------
@@ -25,7 +26,15 @@
 ThreadedKernel::ThreadedKernel(int argc, char **argv)
 {
     randomSlice = FALSE;
+    tickless = FALSE;
+    benchmark = FALSE;
+    forkBenchmark = 0;
+    pendingBenchmark = 0;
+    lockBenchmark = 0;
     type = RR;
+    numLevels = 0;
+    numClassQuanta = 0;
+    threadReport = csvReport = FALSE;
 
     for (int i = 1; i < argc; i++)
     {
@@ -63,6 +72,111 @@ ThreadedKernel::ThreadedKernel(int argc, char **argv)
             {
                 type = SJF;
             }
+            else if (strcmp(argv[i + 1], "SRTF") == 0)
+            {
+                type = SRTF;
+            }
+            else if (strcmp(argv[i + 1], "MLFQ") == 0)
+            {
+                type = MLFQ;
+            }
+            else if (strcmp(argv[i + 1], "STRIDE") == 0)
+            {
+                type = Stride;
+            }
+            else if (strcmp(argv[i + 1], "LOTTERY") == 0)
+            {
+                type = Lottery;
+            }
+            else if (strcmp(argv[i + 1], "CFS") == 0)
+            {
+                type = CFS;
+            }
+            else if (strcmp(argv[i + 1], "EDF") == 0)
+            {
+                type = EDF;
+            }
+        }
+        else if (strcmp(argv[i], "-sbench") == 0)
+        {
+            ASSERT(i + 1 < argc);
+            benchmark = TRUE;
+            benchSeed = atoi(argv[i + 1]);
+            i++;
+        }
+        else if (strcmp(argv[i], "-stackpool") == 0)
+        {
+            ASSERT(i + 1 < argc);
+            StackPool::SetSize(atoi(argv[i + 1]));
+            i++;
+        }
+        else if (strcmp(argv[i], "-forkbench") == 0)
+        {
+            ASSERT(i + 1 < argc);
+            forkBenchmark = atoi(argv[i + 1]);
+            i++;
+        }
+        else if (strcmp(argv[i], "-ibench") == 0)
+        {
+            ASSERT(i + 1 < argc);
+            pendingBenchmark = atoi(argv[i + 1]);
+            ASSERT(pendingBenchmark > 0);
+            i++;
+        }
+        else if (strcmp(argv[i], "-lockbench") == 0)
+        {
+            ASSERT(i + 1 < argc);
+            lockBenchmark = atoi(argv[i + 1]);
+            ASSERT(lockBenchmark > 0);
+            i++;
+        }
+        else if (strcmp(argv[i], "-tickless") == 0)
+        {
+            tickless = TRUE;
+        }
+        else if (strcmp(argv[i], "-ts") == 0)
+        {
+            threadReport = TRUE;
+        }
+        else if (strcmp(argv[i], "-csv") == 0)
+        {
+            threadReport = csvReport = TRUE;
+        }
+        else if (strcmp(argv[i], "-quanta") == 0)
+        {
+            // comma-separated quanta of the MLFQ levels, top level first
+            char *q;
+
+            ASSERT(i + 1 < argc);
+            numLevels = 0;
+            for (q = argv[i + 1]; q != NULL; q = strchr(q, ','))
+            {
+                if (*q == ',')
+                {
+                    q++;
+                }
+                ASSERT(numLevels < MaxLevels);
+                quanta[numLevels++] = atoi(q);
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "-pquanta") == 0)
+        {
+            // comma-separated quanta of the priorities, 0 first
+            char *q;
+
+            ASSERT(i + 1 < argc);
+            numClassQuanta = 0;
+            for (q = argv[i + 1]; q != NULL; q = strchr(q, ','))
+            {
+                if (*q == ',')
+                {
+                    q++;
+                }
+                ASSERT(numClassQuanta < NumPriorities);
+                classQuanta[numClassQuanta++] = atoi(q);
+            }
+            i++;
         }
     }
 }
@@ -79,13 +193,26 @@ void ThreadedKernel::Initialize()
     stats = new Statistics();        // collect statistics
     interrupt = new Interrupt;       // start up interrupt handling
     scheduler = new Scheduler(type); // initialize the ready queue
-    alarm = new Alarm(randomSlice);  // start up time slicing
+    if (numLevels > 0)
+    {
+        scheduler->SetQuanta(numLevels, quanta);
+    }
+    if (numClassQuanta > 0)
+    {
+        scheduler->SetClassQuanta(numClassQuanta, classQuanta);
+    }
+    if (threadReport)
+    {
+        scheduler->SetThreadReport(csvReport);
+    }
+    alarm = new Alarm(randomSlice, tickless); // start up time slicing
 
     // We didn't explicitly allocate the current thread we are running in.
     // But if it ever tries to give up the CPU, we better have a Thread
     // object to save its state.
     currentThread = new Thread("main");
     currentThread->setStatus(RUNNING);
+    currentThread->getStats()->firstRunTime = stats->totalTicks;
 
     interrupt->Enable();
 }
@@ -132,6 +259,28 @@ void ThreadedKernel::SelfTest()
 {
     Semaphore *semaphore;
     SynchList<int> *synchList;
+    RWLock *rwLock;
+
+    if (benchmark) // instead of the usual tests
+    {
+        SchedulerBenchmark(benchSeed);
+        return;
+    }
+    if (forkBenchmark > 0)
+    {
+        ForkBenchmark(forkBenchmark);
+        return;
+    }
+    if (pendingBenchmark > 0)
+    {
+        PendingQueueBenchmark(pendingBenchmark);
+        return;
+    }
+    if (lockBenchmark > 0)
+    {
+        LockBenchmark(lockBenchmark);
+        return;
+    }
 
     LibSelfTest(); // test library routines
 
@@ -148,5 +297,19 @@ void ThreadedKernel::SelfTest()
     synchList->SelfTest(9);
     delete synchList;
 
+    // test readers/writer locks
+    rwLock = new RWLock("rwlock");
+    rwLock->SelfTest();
+    delete rwLock;
+
+    // test priority inheritance, if priorities mean anything
+    if (scheduler->getSchedulerType() == Priority)
+    {
+        Lock *lock = new Lock("inheritance");
+
+        lock->SelfTest();
+        delete lock;
+    }
+
     ElevatorSelfTest();
 }
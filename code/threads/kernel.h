@@ -45,7 +45,21 @@ public:
 
 private:
     bool randomSlice; // enable pseudo-random time slicing
+    bool tickless;    // time-slice only when the CPU is contended
+    bool benchmark;   // compare the schedulers, see workload.h
+    unsigned int benchSeed; // with the workloads from this seed
+    int forkBenchmark;      // threads for the fork benchmark, or 0
+    int pendingBenchmark;   // events for the pending interrupt
+                            // queue benchmark, or 0
+    int lockBenchmark;      // acquire/release pairs for the lock
+                            // benchmark, or 0
     SchedulerType type;
+    int numLevels;              // MLFQ levels given with -quanta, or 0
+    int quanta[MaxLevels];      // and their quanta
+    int numClassQuanta;         // priorities given quanta with -pquanta
+    int classQuanta[NumPriorities]; // and their quanta
+    bool threadReport;          // print every thread's history at halt
+    bool csvReport;             // ... as CSV
 };
 
 #endif // KERNEL_H
@@ -26,11 +26,47 @@
 //----------------------------------------------------------------------
 // Compare function
 //----------------------------------------------------------------------
-int PriorityCompare(Thread *a, Thread *b)
+int BurstCompare(Thread *a, Thread *b)
 {
-    if (a->getPriority() == b->getPriority())
+    if (a->getRemainingBurst() == b->getRemainingBurst())
         return 0;
-    return a->getPriority() > b->getPriority() ? 1 : -1;
+    return a->getRemainingBurst() > b->getRemainingBurst() ? 1 : -1;
+}
+
+int VruntimeCompare(Thread *a, Thread *b)
+{
+    int diff = (int)(a->getVruntime() - b->getVruntime());
+
+    if (diff == 0)
+        return 0;
+    return diff > 0 ? 1 : -1;
+}
+
+int DeadlineCompare(Thread *a, Thread *b)
+{
+    RealTimeTask *x = a->getRealTime(), *y = b->getRealTime();
+
+    if (x == NULL || y == NULL) // real-time threads go first
+        return (x == NULL) - (y == NULL);
+    if (x->deadline == y->deadline)
+        return 0;
+    return x->deadline > y->deadline ? 1 : -1;
+}
+
+int PassCompare(Thread *a, Thread *b)
+{
+    int diff = (int)(a->getPass() - b->getPass()); // pass values wrap
+
+    if (diff == 0)
+        return 0;
+    return diff > 0 ? 1 : -1;
+}
+
+// where a thread keeps its slot in the ready heap, so that taking it
+// out of the middle (when its priority changes) is O(log n)
+static int *ReadyHeapIndex(Thread *t)
+{
+    return &t->heapIndex;
 }
 
 //----------------------------------------------------------------------
@@ -47,22 +83,64 @@ Scheduler::Scheduler()
 Scheduler::Scheduler(SchedulerType type)
 {
     schedulerType = type;
+    readyList = NULL;
+    readyHeap = NULL;
     switch (schedulerType)
     {
     case RR:
-        readyList = new List<Thread *>;
+    case FIFO:
+    case Lottery:
+        readyList = new ThreadQueue;
+        break;
+    case Stride:
+        readyHeap = new Heap<Thread *>(PassCompare, ReadyHeapIndex);
+        break;
+    case CFS:
+        readyHeap = new Heap<Thread *>(VruntimeCompare, ReadyHeapIndex);
+        break;
+    case EDF:
+        readyHeap = new Heap<Thread *>(DeadlineCompare, ReadyHeapIndex);
         break;
     case SJF:
-        /* todo */
+    case SRTF:
+        // a ready thread's remaining burst doesn't change until it
+        // runs again, so it is safe to keep them in a heap
+        readyHeap = new Heap<Thread *>(BurstCompare, ReadyHeapIndex);
         break;
     case Priority:
-        readyList = new SortedList<Thread *>(PriorityCompare);
-        break;
-    case FIFO:
-        /* todo */
+    case MLFQ:
+        for (int i = 0; i < NumPriorities; i++)
+        {
+            priorityQueue[i] = new ThreadQueue;
+        }
+        readyLevels = 0;
         break;
     }
     toBeDestroyed = NULL;
+
+    numLevels = DefaultLevels;
+    for (int i = 0; i < NumPriorities; i++)
+    {
+        classQuantum[i] = TimerTicks;
+    }
+    for (int i = 0; i < MaxLevels; i++)
+    {
+        quantum[i] = DefaultQuantum << i;
+        numDispatches[i] = waitTotal[i] = 0;
+        numFinished[i] = turnaroundTotal[i] = 0;
+    }
+    nextBoost = BoostTicks;
+    numBoosts = 0;
+    globalPass = 0;
+    minVruntime = 0;
+    dispatchTime = 0;
+    numSwitches = 0;
+    maxSpread = 0;
+    reserved = 0;
+    sliceStart = 0;
+    historyFirst = historyLast = NULL;
+    historySize = 0;
+    reportThreads = reportCsv = FALSE;
 }
 
 //----------------------------------------------------------------------
@@ -73,6 +151,43 @@ Scheduler::Scheduler(SchedulerType type)
 Scheduler::~Scheduler()
 {
     delete readyList;
+    delete readyHeap;
+    if (schedulerType == Priority || schedulerType == MLFQ)
+    {
+        for (int i = 0; i < NumPriorities; i++)
+        {
+            delete priorityQueue[i];
+        }
+    }
+    while (historyFirst != NULL)
+    {
+        ThreadStats *s = historyFirst;
+
+        historyFirst = s->next;
+        delete s;
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::QueueOf
+// 	Return the priority queue a thread belongs on.  Under MLFQ,
+//	this is the thread's level.  Otherwise, priorities outside of
+//	0..NumPriorities-1 (the timer keeps lowering the running
+//	thread's number) share the queue at that end.
+//----------------------------------------------------------------------
+
+int Scheduler::QueueOf(Thread *thread)
+{
+    int level = thread->getPriority();
+
+    if (schedulerType == MLFQ)
+        return thread->getLevel();
+
+    if (level < 0)
+        return 0;
+    if (level >= NumPriorities)
+        return NumPriorities - 1;
+    return level;
 }
 
 //----------------------------------------------------------------------
@@ -89,7 +204,131 @@ void Scheduler::ReadyToRun(Thread *thread)
     DEBUG(dbgThread, "Putting thread on ready list: " << thread->getName());
 
     thread->setStatus(READY);
-    readyList->Append(thread);
+    thread->setReadySince(kernel->stats->totalTicks);
+    if (thread == kernel->currentThread)
+    {
+        Stop(thread); // fix its place in the ready list now
+    }
+    switch (schedulerType)
+    {
+    case RR:
+    case FIFO:
+    case Lottery:
+        readyList->Append(thread);
+        break;
+    case Stride:
+        if (thread != kernel->currentThread &&
+            (int)(thread->getPass() - globalPass) < 0)
+        {
+            // don't let a thread that has been asleep catch up
+            // on all the CPU it missed
+            thread->setPass(globalPass);
+        }
+        readyHeap->Insert(thread);
+        break;
+    case CFS:
+        if (thread != kernel->currentThread &&
+            (int)(thread->getVruntime() - minVruntime) < 0)
+        {
+            thread->setVruntime(minVruntime);
+        }
+        readyHeap->Insert(thread);
+        break;
+    case EDF:
+        if (thread->getRealTime() != NULL && thread->getRealTime()->throttled)
+        {
+            break; // RealTimeTask::CallBack will put it back
+        }
+        readyHeap->Insert(thread);
+        if (kernel->interrupt->isInHandler() && ShouldPreempt())
+        {
+            kernel->interrupt->YieldOnReturn();
+        }
+        break;
+    case SJF:
+    case SRTF:
+        readyHeap->Insert(thread);
+
+        // a thread woken up by an interrupt handler can preempt right
+        // away; otherwise we wait for the next timer interrupt
+        if (schedulerType == SRTF && kernel->interrupt->isInHandler() &&
+            ShouldPreempt())
+        {
+            kernel->interrupt->YieldOnReturn();
+        }
+        break;
+    case Priority:
+    case MLFQ:
+    {
+        int level = QueueOf(thread);
+
+        priorityQueue[level]->Append(thread);
+        readyLevels |= (1 << level);
+
+        // a thread woken up on a higher level than the running one
+        // preempts it right away, if we can
+        if (schedulerType == MLFQ && kernel->interrupt->isInHandler() &&
+            ShouldPreempt())
+        {
+            kernel->interrupt->YieldOnReturn();
+        }
+        break;
+    }
+    }
+    if (thread != kernel->currentThread &&
+        kernel->currentThread->getStatus() == RUNNING)
+    {
+        ProgramTimer(kernel->currentThread); // it may have to share now
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Remove
+// 	Take a thread that is ready to run off the ready list, without
+//	running it.  Used to move a thread whose priority has changed.
+//
+//	"thread" is the thread to be removed.
+//----------------------------------------------------------------------
+
+void Scheduler::Remove(Thread *thread)
+{
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+    ASSERT(thread->getStatus() == READY);
+
+    // ReadyToRun will start the clock again when it's put back
+    thread->getStats()->waitTotal += kernel->stats->totalTicks - thread->getReadySince();
+    switch (schedulerType)
+    {
+    case RR:
+    case FIFO:
+    case Lottery:
+        readyList->Remove(thread);
+        break;
+    case EDF:
+        if (readyHeap->IsInHeap(thread)) // unless throttled
+        {
+            readyHeap->Remove(thread);
+        }
+        break;
+    case Stride:
+    case CFS:
+    case SJF:
+    case SRTF:
+        readyHeap->Remove(thread);
+        break;
+    case Priority:
+    case MLFQ:
+    {
+        int level = QueueOf(thread);
+
+        priorityQueue[level]->Remove(thread);
+        if (priorityQueue[level]->IsEmpty())
+        {
+            readyLevels &= ~(1 << level);
+        }
+        break;
+    }
+    }
 }
 
 //----------------------------------------------------------------------
@@ -105,6 +344,53 @@ Scheduler::FindNextToRun()
 {
     ASSERT(kernel->interrupt->getLevel() == IntOff);
 
+    switch (schedulerType)
+    {
+    case SJF:
+    case SRTF:
+    case EDF:
+        return readyHeap->IsEmpty() ? NULL : readyHeap->RemoveFront();
+    case Stride:
+        if (readyHeap->IsEmpty())
+        {
+            return NULL;
+        }
+        globalPass = readyHeap->Front()->getPass();
+        return readyHeap->RemoveFront();
+    case Lottery:
+        return readyList->IsEmpty() ? NULL : Draw();
+    case CFS:
+        if (readyHeap->IsEmpty())
+        {
+            return NULL;
+        }
+        if ((int)(readyHeap->Front()->getVruntime() - minVruntime) > 0)
+        {
+            minVruntime = readyHeap->Front()->getVruntime();
+        }
+        return readyHeap->RemoveFront();
+    case Priority:
+    case MLFQ:
+    {
+        Thread *thread;
+        int level;
+
+        if (readyLevels == 0)
+        {
+            return NULL;
+        }
+        level = ffs(readyLevels) - 1; // highest priority non-empty queue
+        thread = priorityQueue[level]->RemoveFront();
+        if (priorityQueue[level]->IsEmpty())
+        {
+            readyLevels &= ~(1 << level);
+        }
+        return thread;
+    }
+    default:
+        break;
+    }
+
     if (readyList->IsEmpty())
     {
         return NULL;
@@ -115,6 +401,817 @@ Scheduler::FindNextToRun()
     }
 }
 
+//----------------------------------------------------------------------
+// Scheduler::ShouldPreempt
+// 	Return TRUE if a ready thread should take the CPU away from the
+//	current thread: under SRTF, if it is predicted to finish its CPU
+//	burst sooner; under MLFQ, if it is on a higher level.
+//----------------------------------------------------------------------
+
+bool Scheduler::ShouldPreempt()
+{
+    Thread *current = kernel->currentThread;
+
+    if (current->getStatus() != RUNNING)
+    {
+        return FALSE;
+    }
+    switch (schedulerType)
+    {
+    case SRTF:
+        return !readyHeap->IsEmpty() &&
+               readyHeap->Front()->getRemainingBurst() < current->getRemainingBurst();
+    case MLFQ:
+        return readyLevels != 0 && ffs(readyLevels) - 1 < current->getLevel();
+    case EDF:
+    {
+        int order;
+
+        if (readyHeap->IsEmpty())
+        {
+            return FALSE;
+        }
+        // an earlier deadline always wins; threads that aren't real-time
+        // just take turns
+        order = DeadlineCompare(readyHeap->Front(), current);
+        return order < 0 || (order == 0 && current->getRealTime() == NULL);
+    }
+    default:
+        return FALSE;
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Charge
+// 	Bill a thread for the CPU time it has used since it was
+//	dispatched (or last charged).
+//
+//	Its virtual runtime goes up by that time, scaled by DefaultTickets
+//	over its tickets, so a thread with twice the tickets ages half as
+//	fast.  Under stride scheduling, its pass also goes up by its
+//	stride for each tick.
+//
+//	A single charge can be long (with -tickless, a thread running
+//	alone isn't charged until another becomes ready), so the products
+//	are worked out in 64 bits; the virtual times themselves wrap
+//	around, and are only ever compared by their difference.
+//----------------------------------------------------------------------
+
+void Scheduler::Charge(Thread *thread)
+{
+    int ran = kernel->stats->totalTicks - dispatchTime;
+    int tickets = thread->getEffectiveTickets();
+    int stride;
+
+    ASSERT(tickets > 0);
+    if (dispatchTime < 0)
+    {
+        return; // not running
+    }
+    dispatchTime = kernel->stats->totalTicks;
+    thread->getStats()->runTotal += ran;
+    thread->setQuantumUsed(thread->getQuantumUsed() + ran);
+    thread->setVruntime(thread->getVruntime() +
+                        (unsigned int)((long long)ran * VruntimeScale *
+                                       DefaultTickets / tickets));
+    if (thread->getRealTime() != NULL)
+    {
+        thread->getRealTime()->budgetLeft -= ran;
+    }
+    if (schedulerType != Stride)
+    {
+        return;
+    }
+    stride = StrideOne / tickets;
+    if (stride == 0)
+    {
+        stride = 1;
+    }
+    thread->setPass(thread->getPass() + (unsigned int)((long long)stride * ran));
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Stop
+// 	Called when a thread gives up the CPU: bill it for the CPU time
+//	it used, and time its CPU burst.  Called as soon as the thread
+//	blocks, so that it isn't billed for time the CPU then spends
+//	idle; calling it again before the thread next runs does nothing.
+//----------------------------------------------------------------------
+
+void Scheduler::Stop(Thread *thread)
+{
+    ASSERT(thread == kernel->currentThread);
+    Charge(thread);
+    dispatchTime = -1;
+    thread->StopBurst(); // time the CPU burst, predict the next one
+}
+
+//----------------------------------------------------------------------
+// Scheduler::AnyReady
+// 	Return TRUE if there's a thread on the ready list.
+//----------------------------------------------------------------------
+
+bool Scheduler::AnyReady()
+{
+    switch (schedulerType)
+    {
+    case RR:
+    case FIFO:
+    case Lottery:
+        return !readyList->IsEmpty();
+    case Priority:
+    case MLFQ:
+        return readyLevels != 0;
+    default:
+        return !readyHeap->IsEmpty();
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::QuantumOf
+// 	Return how long a thread may run before it is preempted, under
+//	RR, Priority, Stride and Lottery: its own quantum if it has one,
+//	otherwise the quantum of its priority.
+//----------------------------------------------------------------------
+
+int Scheduler::QuantumOf(Thread *thread)
+{
+    if (thread->getQuantum() > 0)
+    {
+        return thread->getQuantum();
+    }
+    return classQuantum[QueueOf(thread)];
+}
+
+//----------------------------------------------------------------------
+// Scheduler::ProgramTimer
+// 	Called whenever a thread starts running, or someone joins the
+//	ready list while a thread is running.  Arrange for the running
+//	thread to be interrupted when its quantum is used up -- but only
+//	if there's someone else on the ready list to give the CPU to.
+//	Otherwise, let it run on; the next thread to become ready will
+//	call us again.
+//
+//	Under RR, Priority, Stride and Lottery, a thread keeps what it
+//	has used of its quantum while it waits on the ready list, so it
+//	doesn't lose its turn just because it got the CPU just before a
+//	timer interrupt.
+//
+//	In tickless mode, this also takes the place of the timer
+//	interrupts that SRTF (every TimerTicks) and CFS (at the end of
+//	each timeslice) would check for preemption on.  Schedulers that
+//	never preempt don't need a timer at all.  MLFQ and EDF always
+//	set their own quanta, since a thread's quantum matters to them
+//	even when it is running alone.
+//
+//	"running" is the thread that is running, or about to.
+//----------------------------------------------------------------------
+
+void Scheduler::ProgramTimer(Thread *running)
+{
+    int now = kernel->stats->totalTicks;
+    int left;
+
+    switch (schedulerType)
+    {
+    case RR:
+    case Priority:
+    case Stride:
+    case Lottery:
+        left = QuantumOf(running) - running->getQuantumUsed() - (now - dispatchTime);
+        break;
+    case SRTF:
+    case CFS:
+        if (!kernel->alarm->IsTickless())
+        {
+            return;
+        }
+        left = sliceStart - now + ((schedulerType == CFS) ? Timeslice() : TimerTicks);
+        break;
+    default:
+        return;
+    }
+    if (!AnyReady())
+    {
+        kernel->alarm->StopQuantum();
+        return;
+    }
+    kernel->alarm->StartQuantum(left > 0 ? left : 1);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Timeslice
+// 	Return how long the next thread may run under CFS: the target
+//	latency split evenly among the runnable threads, but never less
+//	than the minimum granularity.
+//----------------------------------------------------------------------
+
+int Scheduler::Timeslice()
+{
+    int runnable = readyHeap->NumInHeap() + 1;	// the ready ones, plus
+						// the one about to run
+    int slice = TargetLatency / runnable;
+
+    return (slice < MinGranularity) ? MinGranularity : slice;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::SampleFairness
+// 	Called on every timer interrupt.  Measure how far apart the
+//	virtual runtimes of the runnable threads are; under a fair
+//	scheduler, they should never get far apart.
+//----------------------------------------------------------------------
+
+static unsigned int sampleMin, sampleMax;
+
+static void
+SampleVruntime(Thread *thread)
+{
+    if ((int)(thread->getVruntime() - sampleMin) < 0)
+        sampleMin = thread->getVruntime();
+    if ((int)(thread->getVruntime() - sampleMax) > 0)
+        sampleMax = thread->getVruntime();
+}
+
+void Scheduler::SampleFairness()
+{
+    Thread *current = kernel->currentThread;
+
+    if (current->getStatus() != RUNNING)
+    {
+        return;
+    }
+    Charge(current);
+    sampleMin = sampleMax = current->getVruntime();
+    Apply(SampleVruntime);
+    if ((int)(sampleMax - sampleMin) > maxSpread)
+    {
+        maxSpread = sampleMax - sampleMin;
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Draw
+// 	Hold a lottery among the ready threads, each holding as many
+//	tickets as it has of its own plus those lent to it, and take the
+//	winner off the ready list.
+//----------------------------------------------------------------------
+
+Thread *
+Scheduler::Draw()
+{
+    Thread *thread;
+    int total = 0;
+    int winner;
+
+    for (thread = readyList->Front(); thread != NULL; thread = readyList->Next(thread))
+    {
+        total += thread->getEffectiveTickets();
+    }
+    ASSERT(total > 0);
+    winner = RandomNumber() % total;
+
+    for (thread = readyList->Front(); thread != NULL; thread = readyList->Next(thread))
+    {
+        winner -= thread->getEffectiveTickets();
+        if (winner < 0)
+        {
+            break;
+        }
+    }
+    readyList->Remove(thread);
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Admit
+// 	Make a thread periodic: every "period" ticks it does a job that
+//	needs at most "budget" ticks of CPU, and must be done within
+//	"deadline" ticks.  Under EDF, its jobs are scheduled by deadline,
+//	and it is throttled once it has used its budget for the period.
+//
+//	Returns FALSE, leaving the thread alone, if admitting it would
+//	reserve more than the whole CPU (for implicit deadlines, the
+//	EDF utilization bound).
+//----------------------------------------------------------------------
+
+bool Scheduler::Admit(Thread *thread, int period, int budget, int deadline)
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    RealTimeTask *task;
+    bool queued;
+
+    ASSERT(thread->getRealTime() == NULL);
+    task = new RealTimeTask(thread, period, budget, deadline);
+    if (reserved + task->density > UtilizationScale)
+    {
+        DEBUG(dbgThread, "Not admitting " << thread->getName() << ": "
+                                          << reserved << " of " << UtilizationScale
+                                          << " already reserved");
+        delete task;
+        (void)kernel->interrupt->SetLevel(oldLevel);
+        return FALSE;
+    }
+    reserved += task->density;
+
+    queued = (thread->getStatus() == READY); // its place in line changes
+    if (queued)
+    {
+        Remove(thread);
+    }
+    thread->setRealTime(task);
+    if (queued)
+    {
+        ReadyToRun(thread);
+    }
+    (void)kernel->interrupt->SetLevel(oldLevel);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::EndJob
+// 	Called when a periodic thread has finished its job for this
+//	period.  Record how late it was, and put the thread to sleep
+//	until its next period starts.  If that has already happened,
+//	the next job starts right away.
+//----------------------------------------------------------------------
+
+void Scheduler::EndJob(Thread *thread)
+{
+    RealTimeTask *task = thread->getRealTime();
+    int nextPeriod;
+
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+    kernel->stats->RecordLateness(kernel->stats->totalTicks - task->jobDeadline);
+
+    Charge(thread);
+    nextPeriod = task->release + task->period - kernel->stats->totalTicks;
+    if (nextPeriod > 0)
+    {
+        task->waiting = TRUE;
+        kernel->interrupt->Schedule(task, nextPeriod, TimerInt);
+        thread->Sleep(FALSE);
+    }
+    else
+    {
+        task->NextPeriod();
+        task->jobDeadline = task->deadline;
+        if (schedulerType == EDF)
+        {
+            kernel->alarm->StartQuantum(task->budgetLeft);
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Release
+// 	Called from the interrupt handler for the start of a periodic
+//	thread's next period.  Refill its budget, and if it was throttled
+//	or waiting for its next job, let it run again.
+//----------------------------------------------------------------------
+
+void Scheduler::Release(Thread *thread)
+{
+    RealTimeTask *task = thread->getRealTime();
+
+    task->NextPeriod();
+    if (task->waiting)
+    {
+        task->waiting = FALSE;
+        task->jobDeadline = task->deadline;
+    }
+    ReadyToRun(thread);
+}
+
+//----------------------------------------------------------------------
+// RealTimeTask::RealTimeTask
+// 	Initialize the real-time state of a periodic thread, whose
+//	first period starts now.
+//----------------------------------------------------------------------
+
+RealTimeTask::RealTimeTask(Thread *t, int p, int b, int d)
+{
+    ASSERT(p > 0 && b > 0 && b <= d);
+    thread = t;
+    period = p;
+    budget = b;
+    relativeDeadline = d;
+    density = budget * UtilizationScale / (d < p ? d : p);
+    release = kernel->stats->totalTicks;
+    deadline = jobDeadline = release + relativeDeadline;
+    budgetLeft = budget;
+    throttled = waiting = FALSE;
+}
+
+//----------------------------------------------------------------------
+// RealTimeTask::NextPeriod
+// 	Move on to the next period: a new deadline and a full budget.
+//----------------------------------------------------------------------
+
+void RealTimeTask::NextPeriod()
+{
+    release += period;
+    deadline = release + relativeDeadline;
+    budgetLeft = budget;
+    throttled = FALSE;
+}
+
+//----------------------------------------------------------------------
+// RealTimeTask::CallBack
+// 	Interrupt handler for the start of the next period.
+//----------------------------------------------------------------------
+
+void RealTimeTask::CallBack()
+{
+    kernel->scheduler->Release(thread);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::SetQuanta
+// 	Set the number of MLFQ levels, and the quantum of each.
+//
+//	"levels" is the number of levels, at most MaxLevels.
+//	"quanta" is the quantum of each level, in ticks, top level first.
+//----------------------------------------------------------------------
+
+void Scheduler::SetQuanta(int levels, int *quanta)
+{
+    ASSERT(levels > 0 && levels <= MaxLevels);
+    numLevels = levels;
+    for (int i = 0; i < levels; i++)
+    {
+        ASSERT(quanta[i] > 0);
+        quantum[i] = quanta[i];
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::SetClassQuanta
+// 	Set the default quantum of each priority, for RR, Priority,
+//	Stride and Lottery.  A thread can also be given a quantum of its
+//	own with Thread::setQuantum.
+//
+//	"n" is the number of quanta given; priorities from n on get the
+//	last one.
+//	"quanta" is the quantum of each priority, in ticks, priority 0
+//	first.
+//----------------------------------------------------------------------
+
+void Scheduler::SetClassQuanta(int n, int *quanta)
+{
+    ASSERT(n > 0 && n <= NumPriorities);
+    for (int i = 0; i < NumPriorities; i++)
+    {
+        classQuantum[i] = quanta[(i < n) ? i : n - 1];
+        ASSERT(classQuantum[i] > 0);
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::QuantumExpired
+// 	Called from the alarm's quantum timer interrupt handler when
+//	the running thread has used up its whole MLFQ quantum.  Move it
+//	down a level, and give the CPU to someone else if there's anyone
+//	waiting.
+//
+//	The thread gets a new quantum at its new level right away, in
+//	case there's no one else to run.
+//
+//	Under CFS, the quantum is the thread's timeslice, and there are
+//	no levels; the thread just goes back in the heap.
+//
+//	Under EDF, the quantum is what's left of a real-time thread's
+//	budget for this period.  Once that's gone, the thread is
+//	throttled: it isn't put back on the ready list until its next
+//	period starts.
+//
+//	Under RR, Priority, Stride and Lottery, the quantum is the
+//	thread's own, or that of its priority.  Once it is used up, the
+//	thread starts a new one, behind whoever else is ready.  In
+//	tickless mode, SRTF uses the quantum in place of the timer
+//	interrupt it would have had; see ProgramTimer.
+//----------------------------------------------------------------------
+
+void Scheduler::QuantumExpired()
+{
+    Thread *current = kernel->currentThread;
+
+    if (schedulerType == EDF)
+    {
+        RealTimeTask *task = current->getRealTime();
+        int nextPeriod;
+
+        ASSERT(task != NULL);
+        Charge(current);
+        if (task->budgetLeft > 0) // not really over budget yet
+        {
+            kernel->alarm->StartQuantum(task->budgetLeft);
+            return;
+        }
+        nextPeriod = task->release + task->period - kernel->stats->totalTicks;
+        if (nextPeriod <= 0) // already late; carry on in the next period
+        {
+            task->NextPeriod();
+            kernel->alarm->StartQuantum(task->budgetLeft);
+            return;
+        }
+        DEBUG(dbgThread, "Throttling " << current->getName() << " for "
+                                       << nextPeriod << " ticks");
+        task->throttled = TRUE;
+        kernel->interrupt->Schedule(task, nextPeriod, TimerInt);
+        kernel->interrupt->YieldOnReturn();
+        return;
+    }
+
+    if (schedulerType == CFS)
+    {
+        DEBUG(dbgThread, "Timeslice expired, " << current->getName());
+        sliceStart = kernel->stats->totalTicks;
+        if (kernel->alarm->IsTickless())
+        {
+            SampleFairness(); // there's no timer to do it
+            ProgramTimer(current);
+        }
+        else
+        {
+            kernel->alarm->StartQuantum(Timeslice());
+        }
+        if (!readyHeap->IsEmpty())
+        {
+            kernel->interrupt->YieldOnReturn();
+        }
+        return;
+    }
+
+    if (schedulerType == SRTF) // the tick we skipped, in tickless mode
+    {
+        kernel->alarm->Tick();
+        sliceStart = kernel->stats->totalTicks;
+        ProgramTimer(current);
+        return;
+    }
+
+    if (schedulerType != MLFQ) // RR, Priority, Stride, Lottery
+    {
+        if (kernel->alarm->IsTickless())
+        {
+            kernel->alarm->Tick(); // the bookkeeping we skipped
+        }
+        Charge(current);
+        if (current->getQuantumUsed() >= QuantumOf(current))
+        {
+            DEBUG(dbgThread, "Quantum expired, " << current->getName());
+            current->setQuantumUsed(0); // a fresh one next time
+            if (AnyReady())
+            {
+                kernel->interrupt->YieldOnReturn();
+            }
+        }
+        ProgramTimer(current);
+        return;
+    }
+
+    if (kernel->alarm->IsTickless())
+    {
+        CheckBoost(); // there's no timer to do it
+    }
+    if (current->getLevel() < numLevels - 1)
+    {
+        current->setLevel(current->getLevel() + 1);
+    }
+    DEBUG(dbgThread, "Quantum expired, " << current->getName()
+                                         << " now on level " << current->getLevel());
+
+    kernel->alarm->StartQuantum(quantum[current->getLevel()]);
+    if (readyLevels != 0)
+    {
+        kernel->interrupt->YieldOnReturn();
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::CheckBoost
+// 	Called on every timer interrupt.  Every BoostTicks, move all
+//	the ready threads, and the running one, to the top MLFQ level,
+//	so that CPU-bound threads that have sunk to the bottom can't
+//	be starved by a stream of interactive ones.
+//
+//	Blocked threads don't need it: they move up a level each time
+//	they block anyway.
+//----------------------------------------------------------------------
+
+void Scheduler::CheckBoost()
+{
+    if (schedulerType != MLFQ || kernel->stats->totalTicks < nextBoost)
+    {
+        return;
+    }
+    nextBoost = kernel->stats->totalTicks + BoostTicks;
+    numBoosts++;
+    DEBUG(dbgThread, "Boosting all threads to the top level");
+
+    for (int level = 1; level < numLevels; level++)
+    {
+        while (!priorityQueue[level]->IsEmpty())
+        {
+            Thread *thread = priorityQueue[level]->RemoveFront();
+
+            thread->setLevel(0);
+            priorityQueue[0]->Append(thread);
+            readyLevels |= 1;
+        }
+        readyLevels &= ~(1 << level);
+    }
+    if (kernel->currentThread->getStatus() == RUNNING)
+    {
+        kernel->currentThread->setLevel(0);
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Register
+// 	Called when a thread is created.  Keep its history, so that we
+//	can still report on it after it has finished and been deleted.
+//----------------------------------------------------------------------
+
+void Scheduler::Register(ThreadStats *s)
+{
+    if (historyLast == NULL)
+    {
+        historyFirst = s;
+    }
+    else
+    {
+        historyLast->next = s;
+    }
+    historyLast = s;
+    historySize++;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::SetThreadReport
+// 	Ask for the history of every thread to be printed when Nachos
+//	halts, one line per thread.
+//
+//	"csv" is set to print it as comma-separated values, with a
+//	header line, for loading into a spreadsheet or plotting script.
+//----------------------------------------------------------------------
+
+void Scheduler::SetThreadReport(bool csv)
+{
+    reportThreads = TRUE;
+    reportCsv = csv;
+}
+
+//----------------------------------------------------------------------
+// PrintPercentiles
+// 	Sort a set of times, and print their median, 95th and 99th
+//	percentiles and maximum.  A percentile is the smallest time that
+//	at least that percent of the times are no more than.
+//----------------------------------------------------------------------
+
+static int
+CompareTimes(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+static void
+PrintPercentiles(const char *what, int *times, int n)
+{
+    static const int percents[] = {50, 95, 99};
+
+    cout << what << " (" << n << " threads):";
+    if (n == 0)
+    {
+        cout << " n/a\n";
+        return;
+    }
+    qsort(times, n, sizeof(int), CompareTimes);
+    for (int i = 0; i < 3; i++)
+    {
+        int rank = (percents[i] * n + 99) / 100; // rounded up
+
+        cout << " p" << percents[i] << " " << times[rank - 1] << ",";
+    }
+    cout << " max " << times[n - 1] << " ticks\n";
+}
+
+//----------------------------------------------------------------------
+// Scheduler::PrintThreadStats
+// 	Print percentiles of the response time (creation to first run),
+//	waiting time (on the ready list) and turnaround time (creation
+//	to finish) of all the threads we've seen.  Threads that never
+//	ran, or never finished, are left out of the times they don't
+//	have.
+//
+//	If asked to, also print each thread's history.
+//----------------------------------------------------------------------
+
+void Scheduler::PrintThreadStats()
+{
+    int n = historySize;
+    int *response = new int[n], *waiting = new int[n], *turnaround = new int[n];
+    int numResponse = 0, numWaiting = 0, numTurnaround = 0;
+
+    if (reportThreads && reportCsv)
+    {
+        cout << "id,name,created,first_run,finished,response,waiting,"
+             << "running,turnaround,preemptions,yields\n";
+    }
+    for (ThreadStats *s = historyFirst; s != NULL; s = s->next)
+    {
+        bool ran = (s->firstRunTime >= 0), finished = (s->finishTime >= 0);
+
+        if (ran)
+        {
+            response[numResponse++] = s->ResponseTime();
+        }
+        waiting[numWaiting++] = s->waitTotal;
+        if (finished)
+        {
+            turnaround[numTurnaround++] = s->TurnaroundTime();
+        }
+        if (!reportThreads)
+        {
+            continue;
+        }
+        if (reportCsv) // leave out what didn't happen
+        {
+            cout << s->threadID << "," << s->name << "," << s->createTime << ",";
+            if (ran)
+                cout << s->firstRunTime;
+            cout << ",";
+            if (finished)
+                cout << s->finishTime;
+            cout << ",";
+            if (ran)
+                cout << s->ResponseTime();
+            cout << "," << s->waitTotal << "," << s->runTotal << ",";
+            if (finished)
+                cout << s->TurnaroundTime();
+            cout << "," << s->numPreemptions << "," << s->numYields << "\n";
+            continue;
+        }
+        cout << "Thread " << s->threadID << " (" << s->name << "): created "
+             << s->createTime;
+        if (ran)
+            cout << ", response " << s->ResponseTime();
+        cout << ", waited " << s->waitTotal << ", ran " << s->runTotal;
+        if (finished)
+            cout << ", turnaround " << s->TurnaroundTime();
+        else
+            cout << ", not finished";
+        cout << ", preempted " << s->numPreemptions << ", yielded "
+             << s->numYields << "\n";
+    }
+
+    PrintPercentiles("Response time", response, numResponse);
+    PrintPercentiles("Waiting time", waiting, numWaiting);
+    PrintPercentiles("Turnaround time", turnaround, numTurnaround);
+    delete[] response;
+    delete[] waiting;
+    delete[] turnaround;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::PrintStats
+// 	Print the number of context switches, and how far apart the
+//	runnable threads' virtual runtimes got (the fairness of the
+//	schedule; see SampleFairness).
+//
+//	Under MLFQ, also print for each level how long threads waited
+//	on it before running (their response time) and the turnaround
+//	time of the threads that finished on it.
+//----------------------------------------------------------------------
+
+void Scheduler::PrintStats()
+{
+    cout << "Scheduler: " << numSwitches << " context switches, "
+         << "max virtual runtime spread " << maxSpread / VruntimeScale << " ticks\n";
+    PrintThreadStats();
+    if (schedulerType != MLFQ)
+    {
+        return;
+    }
+    cout << "MLFQ: " << numLevels << " levels, " << numBoosts << " boosts\n";
+    for (int i = 0; i < numLevels; i++)
+    {
+        cout << "MLFQ level " << i << " (quantum " << quantum[i]
+             << "): dispatches " << numDispatches[i];
+        if (numDispatches[i] > 0)
+        {
+            cout << ", mean response " << waitTotal[i] / numDispatches[i] << " ticks";
+        }
+        cout << ", finished " << numFinished[i];
+        if (numFinished[i] > 0)
+        {
+            cout << ", mean turnaround " << turnaroundTotal[i] / numFinished[i] << " ticks";
+        }
+        cout << "\n";
+    }
+}
+
 //----------------------------------------------------------------------
 // Scheduler::Run
 // 	Dispatch the CPU to nextThread.  Save the state of the old thread,
@@ -135,6 +1232,7 @@ Scheduler::FindNextToRun()
 void Scheduler::Run(Thread *nextThread, bool finishing)
 {
     Thread *oldThread = kernel->currentThread;
+    ThreadStats *nextStats = nextThread->getStats();
 
     //	cout << "Current Thread" <<oldThread->getName() << "    Next Thread"<<nextThread->getName()<<endl;
 
@@ -157,6 +1255,70 @@ void Scheduler::Run(Thread *nextThread, bool finishing)
     oldThread->CheckOverflow(); // check if the old thread
                                 // had an undetected stack overflow
 
+    Stop(oldThread);
+    if (finishing && (schedulerType == SJF || schedulerType == SRTF))
+    {
+        oldThread->PrintBursts();
+    }
+    nextThread->StartBurst();
+    dispatchTime = kernel->stats->totalTicks;
+    nextStats->waitTotal += dispatchTime - nextStats->readySince;
+    if (nextStats->firstRunTime < 0)
+    {
+        nextStats->firstRunTime = dispatchTime;
+    }
+    if (nextThread != oldThread)
+    {
+        numSwitches++;
+    }
+    sliceStart = dispatchTime;
+    if (oldThread->getStatus() == BLOCKED)
+    {
+        oldThread->setQuantumUsed(0); // a fresh quantum when it wakes up
+    }
+    if (schedulerType == CFS && !kernel->alarm->IsTickless())
+    {
+        kernel->alarm->StartQuantum(Timeslice());
+    }
+    ProgramTimer(nextThread);
+    if (schedulerType == EDF)
+    {
+        if (nextThread->getRealTime() != NULL) // enforce its budget
+        {
+            int budgetLeft = nextThread->getRealTime()->budgetLeft;
+
+            kernel->alarm->StartQuantum(budgetLeft > 0 ? budgetLeft : 1);
+        }
+        else
+        {
+            kernel->alarm->StopQuantum();
+        }
+    }
+    if (finishing && oldThread->getRealTime() != NULL)
+    {
+        reserved -= oldThread->getRealTime()->density;
+    }
+
+    if (schedulerType == MLFQ)
+    {
+        int level = nextThread->getLevel();
+
+        if (finishing)
+        {
+            numFinished[oldThread->getLevel()]++;
+            turnaroundTotal[oldThread->getLevel()] +=
+                kernel->stats->totalTicks - oldThread->getCreateTime();
+        }
+        else if (oldThread->getStatus() == BLOCKED && oldThread->getLevel() > 0)
+        {
+            // gave up the CPU before its quantum ran out
+            oldThread->setLevel(oldThread->getLevel() - 1);
+        }
+        numDispatches[level]++;
+        waitTotal[level] += kernel->stats->totalTicks - nextThread->getReadySince();
+        kernel->alarm->StartQuantum(quantum[level]);
+    }
+
     kernel->currentThread = nextThread; // switch to the next thread
     nextThread->setStatus(RUNNING);     // nextThread is now running
 
@@ -214,5 +1376,37 @@ void Scheduler::CheckToBeDestroyed()
 void Scheduler::Print()
 {
     cout << "Ready list contents:\n";
-    readyList->Apply(ThreadPrint);
+    Apply(ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Apply
+// 	Apply a function to every thread on the ready list, in no
+//	particular order.
+//
+//	"func" -- the function to apply
+//----------------------------------------------------------------------
+
+void Scheduler::Apply(void (*func)(Thread *))
+{
+    switch (schedulerType)
+    {
+    case Stride:
+    case CFS:
+    case EDF:
+    case SJF:
+    case SRTF:
+        readyHeap->Apply(func);
+        break;
+    case Priority:
+    case MLFQ:
+        for (int i = 0; i < NumPriorities; i++)
+        {
+            priorityQueue[i]->Apply(func);
+        }
+        break;
+    default:
+        readyList->Apply(func);
+        break;
+    }
 }
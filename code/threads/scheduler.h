@@ -11,17 +11,88 @@
 
 #include "copyright.h"
 #include "list.h"
+#include "heap.h"
 #include "thread.h"
+#include "callback.h"
 
 // The following class defines the scheduler/dispatcher abstraction -- 
 // the data structures and operations needed to keep track of which 
 // thread is running, and which threads are ready but not running.
 
+// Number of priority levels the Priority scheduler keeps apart; one
+// bit of a word each.  Level 0 runs first.
+const int NumPriorities = 32;
+
+// The multi-level feedback queue uses the first few of those levels.
+// Each level has its own quantum; by default they double as we go down.
+const int MaxLevels = 8;		// most MLFQ levels allowed
+const int DefaultLevels = 3;
+const int DefaultQuantum = 100;		// quantum of the top level, in ticks
+const int BoostTicks = 5000;		// how often every thread is moved
+					// back to the top level
+
+// Under stride scheduling, a tick of CPU time costs a thread
+// StrideOne divided by its tickets.
+const int StrideOne = 1 << 16;
+
+// Virtual runtimes are kept in units of 1/VruntimeScale of a tick, so
+// that scaling them by a thread's tickets doesn't round them off.
+const int VruntimeScale = 1024;
+
+// The CFS scheduler tries to run every runnable thread once every
+// TargetLatency ticks, but won't cut timeslices below MinGranularity.
+const int TargetLatency = 400;
+const int MinGranularity = 50;
+
+// Admission control for EDF keeps the total CPU reserved by real-time
+// threads (the sum of budget/min(period, deadline)) at or below 1,
+// in units of 1/UtilizationScale.
+const int UtilizationScale = 10000;
+
 enum SchedulerType {
         RR,     // Round Robin
-        SJF,
+        SJF,    // Shortest Job First, non-preemptive
         Priority,
-		FIFO
+		FIFO,
+        SRTF,   // Shortest Remaining Time First (preemptive SJF)
+        MLFQ,   // Multi-Level Feedback Queue
+        Stride, // proportional share, deterministic
+        Lottery,// proportional share, randomized
+        CFS,    // Completely Fair Scheduler
+        EDF     // Earliest Deadline First, for periodic real-time threads
+};
+
+// The following class defines the real-time parameters and state of a
+// periodic thread admitted by the EDF scheduler.  Every "period" ticks
+// the thread releases a job, which must finish within "deadline" ticks,
+// and may use at most "budget" ticks of CPU time per period; once over
+// budget, the thread is throttled until its next period.
+//
+// This is also the interrupt handler for the start of each period.
+// The fields are public for notational convenience.
+
+class RealTimeTask : public CallBackObj {
+  public:
+    RealTimeTask(Thread *t, int p, int b, int d);
+
+    Thread *thread;		// the periodic thread
+    int period, budget, relativeDeadline;
+    int density;		// budget / min(period, deadline), in
+				// units of 1/UtilizationScale
+    int release;		// when the current period began
+    int deadline;		// absolute deadline, for scheduling
+    int jobDeadline;		// deadline of the job now running, which
+				// may be from an earlier period if the
+				// job overran
+    int budgetLeft;		// CPU time left in this period
+    bool throttled;		// out of budget until the next period
+    bool waiting;		// waiting for the next period to start
+				// its next job
+
+    void NextPeriod();		// start the next period
+
+  private:
+    void CallBack();		// called when the next period starts
 };
 
 class Scheduler {
@@ -34,21 +105,102 @@ class Scheduler {
     					// Thread can be dispatched.
 	Thread* FindNextToRun();	// Dequeue first thread on the ready 
 					// list, if any, and return thread.
+	void Remove(Thread* thread);	// Take a ready thread off the
+					// ready list
 	void Run(Thread* nextThread, bool finishing);
 	    				// Cause nextThread to start running
+	void Stop(Thread* thread);	// The current thread is giving up
+					// the CPU; stop billing it
 	void CheckToBeDestroyed();	// Check if thread that had been
     					// running needs to be deleted
 	void Print();			// Print contents of ready list
+	void Apply(void (*func)(Thread *));
+					// Apply function to every ready thread
+	bool ShouldPreempt();		// Is there a ready thread that should
+					// take the CPU away from the current one?
+
+	void SetQuanta(int levels, int *quanta);
+					// Set the MLFQ levels and their quanta
+	void SetClassQuanta(int n, int *quanta);
+					// Set the quanta of the first n
+					// priorities, for RR, Priority,
+					// Stride and Lottery
+	void QuantumExpired();		// The running thread used up its
+					// whole quantum
+	void CheckBoost();		// Time to move everyone to the top?
+
+	bool Admit(Thread* thread, int period, int budget, int deadline);
+					// Make a thread periodic, if the
+					// CPU isn't reserved already
+	void EndJob(Thread* thread);	// The thread's job is done; wait for
+					// its next period
+	void Release(Thread* thread);	// Start a real-time thread's next
+					// period
+	void SampleFairness();		// Measure the spread of virtual runtimes
+	void Register(ThreadStats *s);	// Keep a new thread's history
+	void SetThreadReport(bool csv);	// Print every thread's history at
+					// the end, as a table or as CSV
+	void PrintStats();		// Print context switches, fairness,
+					// latency percentiles and per-level
+					// MLFQ statistics
     	
     void setSchedulerType(SchedulerType t) {schedulerType = t;}
 	SchedulerType getSchedulerType() {return schedulerType;}
+	int getNumSwitches() { return numSwitches; }
 
     // SelfTest for scheduler is implemented in class Thread
     
   private:
 	SchedulerType schedulerType;
-	List<Thread *> *readyList;	// queue of threads that are ready to run,
+	ThreadQueue *readyList;		// queue of threads that are ready to run,
 					// but not running
+	Heap<Thread *> *readyHeap;	// the same, for SJF and SRTF, ordered
+					// by predicted CPU burst
+	ThreadQueue *priorityQueue[NumPriorities];
+					// the same, for Priority: a FIFO
+					// queue for each priority level
+	unsigned int readyLevels;	// bit i is set if priorityQueue[i]
+					// isn't empty
+	int QueueOf(Thread* thread);	// which priorityQueue a thread goes on
+
+	int numLevels;			// number of MLFQ levels in use
+	int quantum[MaxLevels];		// quantum of each MLFQ level
+	int nextBoost;			// when to next move everyone to the top
+	int numBoosts;
+	int numDispatches[MaxLevels];	// times a thread ran from each level
+	int waitTotal[MaxLevels];	// ticks spent waiting on each level
+	int numFinished[MaxLevels];	// threads that finished at each level
+	int turnaroundTotal[MaxLevels];	// their creation to finish times
+
+	bool AnyReady();		// is any thread on the ready list?
+	void ProgramTimer(Thread* running);
+					// end the running thread's time slice
+					// if someone else is waiting
+	int QuantumOf(Thread* thread);	// how long a thread's quantum is
+	int classQuantum[NumPriorities];// default quantum of each priority
+	int sliceStart;			// when the running thread's time slice
+					// began
+
+	void Charge(Thread* thread);	// bill a thread for its CPU time
+	Thread* Draw();			// pick a Lottery winner
+	int Timeslice();		// CFS timeslice of the next thread
+	unsigned int globalPass;	// pass of the last Stride thread
+					// dispatched
+	unsigned int minVruntime;	// smallest virtual runtime of a CFS
+					// thread dispatched so far
+	int dispatchTime;		// when the current thread got the CPU,
+					// or -1 once it has given it up
+	int numSwitches;		// number of context switches
+	int maxSpread;			// largest gap seen between the virtual
+					// runtimes of two runnable threads
+	int reserved;			// CPU reserved by admitted real-time
+					// threads, out of UtilizationScale
+	ThreadStats *historyFirst;	// every thread we've seen, oldest
+	ThreadStats *historyLast;	// first, linked through "next", so
+	int historySize;		// that recording one allocates nothing
+	bool reportThreads;		// print one line per thread at the end
+	bool reportCsv;			// ... in CSV
+	void PrintThreadStats();	// print the history of every thread
 	Thread *toBeDestroyed;		// finishing thread to be destroyed
     					// by the next thread that runs
 };
@@ -1,7 +1,7 @@
 // synch.cc
-//	Routines for synchronizing threads.  Three kinds of
-//	synchronization routines are defined here: semaphores, locks
-//   	and condition variables.
+//	Routines for synchronizing threads.  Four kinds of
+//	synchronization routines are defined here: semaphores, locks,
+//	condition variables, and readers/writer locks.
 //
 // Any implementation of a synchronization routine needs some
 // primitive atomic operation.  We assume Nachos is running on
@@ -18,12 +18,14 @@
 //
 // Once we'e implemented one set of higher level atomic operations,
 // we can implement others using that implementation.  We illustrate
-// this by implementing locks and condition variables on top of
-// semaphores, instead of directly enabling and disabling interrupts.
+// this by implementing condition variables on top of semaphores, and
+// readers/writer locks on top of locks and condition variables,
+// instead of directly enabling and disabling interrupts.
 //
-// Locks are implemented using a semaphore to keep track of
-// whether the lock is held or not -- a semaphore value of 0 means
-// the lock is busy; a semaphore value of 1 means the lock is free.
+// Locks keep their own queue of waiting threads, rather than using a
+// semaphore, so that taking a free lock and releasing an uncontended
+// one can skip disabling interrupts altogether; and so that the lock
+// holder can inherit the priorities of the threads waiting for it.
 //
 // The implementation of condition variables using semaphores is
 // a bit trickier, as explained below under Condition::Wait.
@@ -48,7 +50,8 @@ Semaphore::Semaphore(char *debugName, int initialValue)
 {
     name = debugName;
     value = initialValue;
-    queue = new List<Thread *>;
+    queue = new ThreadQueue;
+    PROFILE_INIT("Semaphore", debugName);
 }
 
 //----------------------------------------------------------------------
@@ -84,6 +87,8 @@ void Semaphore::P()
 
     // disable interrupts
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    PROFILE_START(start);
+    PROFILE_CONTENDED(contended, value == 0);
 
     while (value == 0)
     {                                 // semaphore not available
@@ -91,11 +96,118 @@ void Semaphore::P()
         currentThread->Sleep(FALSE);
     }
     value--; // semaphore available, consume its value
+    PROFILE_ACQUIRED(contended, start);
 
     // re-enable interrupts
     (void)interrupt->SetLevel(oldLevel);
 }
 
+//----------------------------------------------------------------------
+// Semaphore::P (with a timeout)
+// 	Same as P, but if the value doesn't become > 0 within "timeout"
+//	ticks, give up.  The timeout is an interrupt, scheduled only if
+//	we have to wait and canceled if we don't time out, so a timed P
+//	costs nothing more than a P unless it has to wait.
+//
+//	If the timeout goes off, the thread is taken off the queue and
+//	woken up; it still gets the value if a V came in the meantime.
+//
+//	Returns TRUE if we decremented the value, FALSE if we timed out.
+//----------------------------------------------------------------------
+
+// Interrupt handler for the end of a timed wait.  Private to this
+// module.
+class WaitTimeout : public CallBackObj
+{
+public:
+    WaitTimeout(ThreadQueue *q, Thread *t)
+    {
+        queue = q;
+        thread = t;
+        expired = FALSE;
+    }
+    bool expired; // TRUE once the time is up
+
+private:
+    ThreadQueue *queue; // where the thread is waiting
+    Thread *thread;
+
+    void CallBack()
+    {
+        expired = TRUE;
+        if (queue->IsInList(thread)) // still waiting, so wake it up
+        {
+            queue->Remove(thread);
+            kernel->scheduler->ReadyToRun(thread);
+        }
+    }
+};
+
+bool Semaphore::P(int timeout)
+{
+    Interrupt *interrupt = kernel->interrupt;
+    Thread *currentThread = kernel->currentThread;
+    WaitTimeout timer(queue, currentThread);
+    PendingInterrupt *expiry = NULL;
+
+    if (timeout <= 0)
+    {
+        return TryP();
+    }
+
+    // disable interrupts
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    PROFILE_START(start);
+    PROFILE_CONTENDED(contended, value == 0);
+
+    while (value == 0)
+    { // semaphore not available
+        if (timer.expired)
+        {
+            PROFILE_GAVE_UP(start);
+            (void)interrupt->SetLevel(oldLevel);
+            return FALSE;
+        }
+        if (expiry == NULL)
+        {
+            expiry = interrupt->Schedule(&timer, timeout, TimerInt);
+        }
+        queue->Append(currentThread); // so go to sleep
+        currentThread->Sleep(FALSE);
+    }
+    value--; // semaphore available, consume its value
+    if (expiry != NULL && !timer.expired)
+    {
+        interrupt->Cancel(expiry);
+    }
+    PROFILE_ACQUIRED(contended, start);
+
+    // re-enable interrupts
+    (void)interrupt->SetLevel(oldLevel);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Semaphore::TryP
+// 	Decrement the value if it is > 0, without waiting.
+//
+//	Returns TRUE if we decremented the value.
+//----------------------------------------------------------------------
+
+bool Semaphore::TryP()
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    bool available = (value > 0);
+
+    if (available)
+    {
+        value--;
+        PROFILE_ACQUIRED(FALSE, kernel->stats->totalTicks);
+    }
+    (void)kernel->interrupt->SetLevel(oldLevel);
+    return available;
+}
+
 //----------------------------------------------------------------------
 // Semaphore::V
 // 	Increment semaphore value, waking up a waiter if necessary.
@@ -151,6 +263,17 @@ void Semaphore::SelfTest()
         this->P();
     }
     delete ping;
+
+    // a timed P gives up once its time is up, unless there's a V
+    int start = kernel->stats->totalTicks;
+
+    ASSERT(!TryP());
+    ASSERT(!P(100));
+    ASSERT(kernel->stats->totalTicks >= start + 100);
+    V();
+    ASSERT(P(100));
+    V();
+    ASSERT(TryP());
 }
 
 //----------------------------------------------------------------------
@@ -164,8 +287,12 @@ void Semaphore::SelfTest()
 Lock::Lock(char *debugName)
 {
     name = debugName;
-    semaphore = new Semaphore("lock", 1); // initially, unlocked
-    lockHolder = NULL;
+    lockHolder = NULL; // initially, unlocked
+    queue = new ThreadQueue;
+    waitingTickets = 0;
+    waiters = new List<Thread *>;
+    nextHeld = NULL;
+    PROFILE_INIT("Lock", debugName);
 }
 
 //----------------------------------------------------------------------
@@ -174,7 +301,8 @@ Lock::Lock(char *debugName)
 //----------------------------------------------------------------------
 Lock::~Lock()
 {
-    delete semaphore;
+    delete queue;
+    delete waiters;
 }
 
 char *
@@ -185,38 +313,448 @@ Lock::getName()
 //----------------------------------------------------------------------
 // Lock::Acquire
 //	Atomically wait until the lock is free, then set it to busy.
-//	Equivalent to Semaphore::P(), with the semaphore value of 0
-//	equal to busy, and semaphore value of 1 equal to free.
+//
+//	If the lock is free and no one is waiting for it, we just take
+//	it.  There is no need to disable interrupts for that: threads
+//	are only switched when simulated time advances, or when a thread
+//	gives up the CPU, and neither can happen in between.  Leaving
+//	the interrupt level alone means the uncontended case takes no
+//	simulated time at all.
+//
+//	Otherwise, we wait on the lock's queue, as in Semaphore::P.
+//	While we wait, we lend our scheduling tickets to the lock
+//	holder, so that under the proportional-share schedulers it gets
+//	the lock out of our way sooner, and it inherits our priority if
+//	that is better than its own.  Once we have the lock, the tickets
+//	and priorities of everyone still waiting go to us instead.
 //----------------------------------------------------------------------
 
 void Lock::Acquire()
 {
-    semaphore->P();
+    Thread *currentThread = kernel->currentThread;
+    IntStatus oldLevel;
+    int lent;
+
+    if (lockHolder == NULL && waiters->IsEmpty()) // fast path
+    {
+        lockHolder = currentThread;
+        currentThread->AddHeldLock(this);
+        PROFILE_LOCKED(FALSE, kernel->stats->totalTicks);
+        return;
+    }
+
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    PROFILE_START(start);
+    PROFILE_CONTENDED(contended, lockHolder != NULL);
+    lent = StartWaiting();
+    while (lockHolder != NULL)
+    {
+        queue->Append(currentThread); // so go to sleep
+        currentThread->Sleep(FALSE);
+    }
+    StopWaiting(lent);
+    Take();
+    PROFILE_LOCKED(contended, start);
+    (void)kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Lock::Acquire (with a timeout)
+//	Same as Acquire, but give up if the lock hasn't been released to
+//	us within "timeout" ticks.  If we give up, we take back the
+//	tickets and priority we lent to whoever holds the lock now.
+//
+//	Returns TRUE if we got the lock.
+//----------------------------------------------------------------------
+
+bool Lock::Acquire(int timeout)
+{
+    Thread *currentThread = kernel->currentThread;
+    WaitTimeout timer(queue, currentThread);
+    PendingInterrupt *expiry = NULL;
+    IntStatus oldLevel;
+    int lent;
+    bool acquired;
+
+    if (lockHolder == NULL && waiters->IsEmpty()) // fast path
+    {
+        lockHolder = currentThread;
+        currentThread->AddHeldLock(this);
+        PROFILE_LOCKED(FALSE, kernel->stats->totalTicks);
+        return TRUE;
+    }
+    if (timeout <= 0)
+    {
+        return TryAcquire();
+    }
+
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    PROFILE_START(start);
+    PROFILE_CONTENDED(contended, lockHolder != NULL);
+    lent = StartWaiting();
+    while (lockHolder != NULL && !timer.expired)
+    {
+        if (expiry == NULL)
+        {
+            expiry = kernel->interrupt->Schedule(&timer, timeout, TimerInt);
+        }
+        queue->Append(currentThread); // so go to sleep
+        currentThread->Sleep(FALSE);
+    }
+    acquired = (lockHolder == NULL);
+    if (expiry != NULL && !timer.expired)
+    {
+        kernel->interrupt->Cancel(expiry);
+    }
+    StopWaiting(lent);
+    if (acquired)
+    {
+        Take();
+        PROFILE_LOCKED(contended, start);
+    }
+    else
+    {
+        PROFILE_GAVE_UP(start);
+    }
+    (void)kernel->interrupt->SetLevel(oldLevel);
+    return acquired;
+}
+
+//----------------------------------------------------------------------
+// Lock::TryAcquire
+//	Set the lock to busy if it is free, without waiting.
+//
+//	Returns TRUE if we got the lock.
+//----------------------------------------------------------------------
+
+bool Lock::TryAcquire()
+{
+    IntStatus oldLevel;
+
+    if (lockHolder != NULL)
+    {
+        return FALSE;
+    }
+    if (waiters->IsEmpty()) // fast path
+    {
+        lockHolder = kernel->currentThread;
+        lockHolder->AddHeldLock(this);
+        PROFILE_LOCKED(FALSE, kernel->stats->totalTicks);
+        return TRUE;
+    }
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    Take();
+    PROFILE_LOCKED(FALSE, kernel->stats->totalTicks);
+    (void)kernel->interrupt->SetLevel(oldLevel);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Lock::StartWaiting
+//	If the lock is busy, so that the current thread will have to
+//	wait, lend the holder our tickets, and let it inherit our
+//	priority.
+//
+//	Returns the number of tickets lent.
+//----------------------------------------------------------------------
+
+int Lock::StartWaiting()
+{
+    Thread *currentThread = kernel->currentThread;
+    int lent;
+
+    if (lockHolder == NULL)
+    {
+        return 0;
+    }
+    lent = currentThread->getTickets();
+    waitingTickets += lent;
+    lockHolder->LendTickets(lent);
+
+    waiters->Append(currentThread);
+    currentThread->setWaitingFor(this);
+    lockHolder->UpdatePriority();
+    return lent;
+}
+
+//----------------------------------------------------------------------
+// Lock::StopWaiting
+//	The current thread has stopped waiting for the lock, either
+//	because it got it or because it timed out.  In the latter case,
+//	the holder gives back what we lent it.
+//----------------------------------------------------------------------
+
+void Lock::StopWaiting(int lent)
+{
+    Thread *currentThread = kernel->currentThread;
+
+    waitingTickets -= lent;
+    if (currentThread->getWaitingFor() != this)
+    {
+        return; // never waited
+    }
+    waiters->Remove(currentThread);
+    currentThread->setWaitingFor(NULL);
+    if (lockHolder != NULL) // timed out
+    {
+        lockHolder->LendTickets(-lent);
+        lockHolder->UpdatePriority();
+    }
+}
+
+//----------------------------------------------------------------------
+// Lock::Take
+//	The current thread has the lock now: it gets the tickets and
+//	priorities of the threads still waiting.
+//----------------------------------------------------------------------
+
+void Lock::Take()
+{
+    ASSERT(lockHolder == NULL);
     lockHolder = kernel->currentThread;
+    lockHolder->LendTickets(waitingTickets);
+    lockHolder->AddHeldLock(this);
+    lockHolder->UpdatePriority();
 }
 
+#ifdef SYNCH_PROFILE
+//----------------------------------------------------------------------
+// Lock::Profile
+//	Record that the current thread has got the lock, and when, after
+//	waiting since "start" if "contended".
+//----------------------------------------------------------------------
+
+void Lock::Profile(bool contended, int start)
+{
+    acquiredAt = kernel->stats->totalTicks;
+    profile->Acquired(contended, acquiredAt - start);
+}
+#endif
+
 //----------------------------------------------------------------------
 // Lock::Release
-//	Atomically set lock to be free, waking up a thread waiting
-//	for the lock, if any.
-//	Equivalent to Semaphore::V(), with the semaphore value of 0
-//	equal to busy, and semaphore value of 1 equal to free.
+//	Atomically set lock to be free, waking up the waiting thread
+//	with the best (lowest) priority, if any; among equals, the one
+//	that has waited longest.
 //
 //	By convention, only the thread that acquired the lock
-// 	may release it.
+// 	may release it.  It gives back the tickets lent to it by the
+//	threads waiting for the lock, and any priority it inherited
+//	from them.  If no one is waiting, there is nothing to give
+//	back or wake up, and, as in Acquire, we leave interrupts alone.
 //---------------------------------------------------------------------
 
 void Lock::Release()
 {
+    Thread *holder = lockHolder;
+    Thread *best;
+    IntStatus oldLevel;
+
     ASSERT(IsHeldByCurrentThread());
+    PROFILE_UNLOCKED();
+    if (waiters->IsEmpty()) // fast path
+    {
+        ASSERT(queue->IsEmpty());
+        holder->RemoveHeldLock(this);
+        lockHolder = NULL;
+        return;
+    }
+
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    holder->LendTickets(-waitingTickets); // take back the waiters' tickets
+    holder->RemoveHeldLock(this);
     lockHolder = NULL;
-    semaphore->V();
+    holder->UpdatePriority(); // and their priorities
+    if (!queue->IsEmpty())
+    { // make the most urgent thread ready
+        best = queue->Front();
+        for (Thread *t = queue->Next(best); t != NULL; t = queue->Next(t))
+        {
+            if (t->getPriority() < best->getPriority())
+            {
+                best = t;
+            }
+        }
+        queue->Remove(best);
+        kernel->scheduler->ReadyToRun(best);
+    }
+    (void)kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Lock::DonatedPriority
+//	Return the best (lowest) of "priority" and the priorities of the
+//	threads waiting for the lock.
+//----------------------------------------------------------------------
+
+int Lock::DonatedPriority(int priority)
+{
+    ListIterator<Thread *> iter(waiters);
+
+    for (; !iter.IsDone(); iter.Next())
+    {
+        if (iter.Item()->getPriority() < priority)
+        {
+            priority = iter.Item()->getPriority();
+        }
+    }
+    return priority;
 }
 
 bool Lock::IsHeldByCurrentThread()
 {
     return lockHolder == kernel->currentThread;
 }
+
+//----------------------------------------------------------------------
+// Lock::SelfTest, InheritanceLow, InheritanceChain, InheritanceHigh,
+// InheritanceMedium
+// 	Test priority inheritance under the Priority scheduler, with
+//	the classic inversion: a low priority thread holds this lock,
+//	and a high priority thread waits for it while two medium
+//	priority threads compete for the CPU.  Here the high priority
+//	thread waits for a second lock, held by a thread that is itself
+//	waiting for this one, so its priority has to be passed down the
+//	chain.
+//
+//	Without inheritance, the high priority thread would wait for
+//	the medium threads to finish their work; with it, the low
+//	priority thread runs ahead of them and gets out of the way.
+//
+//	Then check that Release hands the lock to the most urgent
+//	waiter rather than the oldest one.
+//----------------------------------------------------------------------
+
+const int InheritanceLowWork = 300;	// ticks spent holding the lock
+const int InheritanceMediumWork = 3000; // ticks of CPU each medium
+					// thread wants
+
+static Lock *outerLock;			// held by the low thread
+static Lock *innerLock;			// held by the chain thread
+static Semaphore *inheritanceDone;	// V'ed by each thread as it finishes
+static int highWait;			// how long the high thread waited
+static Thread *firstWaker;		// first waiter to get the lock back
+
+static void
+Spin(int ticks)
+{
+    for (int used = 0; used < ticks; used += SystemTick)
+    {
+        kernel->interrupt->OneTick();
+    }
+}
+
+static void
+InheritanceChain(int which)
+{
+    innerLock->Acquire();
+    outerLock->Acquire(); // the low thread inherits our priority
+    outerLock->Release();
+    innerLock->Release();
+    ASSERT(kernel->currentThread->getPriority() ==
+           kernel->currentThread->getBasePriority());
+    inheritanceDone->V();
+}
+
+static void
+InheritanceHigh(int which)
+{
+    int start = kernel->stats->totalTicks;
+
+    innerLock->Acquire(); // passed on to the chain, then the low thread
+    highWait = kernel->stats->totalTicks - start;
+    innerLock->Release();
+    inheritanceDone->V();
+}
+
+static void
+InheritanceMedium(int which)
+{
+    Spin(InheritanceMediumWork);
+    inheritanceDone->V();
+}
+
+static void
+InheritanceLow(int which)
+{
+    Thread *t;
+
+    outerLock->Acquire();
+    t = new Thread("chain");
+    t->setPriority(4);
+    t->Fork((VoidFunctionPtr)InheritanceChain, (void *)0);
+    kernel->currentThread->Yield(); // let it wait for us
+    ASSERT(kernel->currentThread->getPriority() <= 4);
+
+    t = new Thread("high");
+    t->setPriority(1);
+    t->Fork((VoidFunctionPtr)InheritanceHigh, (void *)0);
+    for (int i = 0; i < 2; i++)
+    {
+        t = new Thread("medium");
+        t->setPriority(3);
+        t->Fork((VoidFunctionPtr)InheritanceMedium, (void *)i);
+    }
+    Spin(InheritanceLowWork);
+    outerLock->Release();
+    ASSERT(kernel->currentThread->getPriority() ==
+           kernel->currentThread->getBasePriority());
+    inheritanceDone->V();
+}
+
+static void
+Waiter(int which)
+{
+    outerLock->Acquire();
+    if (firstWaker == NULL)
+    {
+        firstWaker = kernel->currentThread;
+    }
+    outerLock->Release();
+    inheritanceDone->V();
+}
+
+void Lock::SelfTest()
+{
+    Thread *low = new Thread("low");
+    Thread *early, *late;
+
+    outerLock = this;
+    innerLock = new Lock("inner");
+    inheritanceDone = new Semaphore("inheritance", 0);
+    low->setPriority(6);
+    low->Fork((VoidFunctionPtr)InheritanceLow, (void *)0);
+    for (int i = 0; i < 5; i++)
+    {
+        inheritanceDone->P();
+    }
+    cout << "Priority inheritance: high priority thread waited " << highWait
+         << " ticks for the lock\n";
+    ASSERT(highWait < InheritanceMediumWork);
+
+    Acquire(); // queue a low priority waiter ahead of a high one
+    early = new Thread("early waiter");
+    early->setPriority(6);
+    early->Fork((VoidFunctionPtr)Waiter, (void *)0);
+    while (waiters->NumInList() < 1)
+    {
+        kernel->currentThread->Yield();
+    }
+    late = new Thread("late waiter");
+    late->setPriority(2);
+    late->Fork((VoidFunctionPtr)Waiter, (void *)1);
+    while (waiters->NumInList() < 2)
+    {
+        kernel->currentThread->Yield();
+    }
+    firstWaker = NULL;
+    Release();
+    inheritanceDone->P();
+    inheritanceDone->P();
+    ASSERT(firstWaker == late);
+    delete innerLock;
+    delete inheritanceDone;
+}
 //----------------------------------------------------------------------
 // Condition::Condition
 // 	Initialize a condition variable, so that it can be
@@ -229,6 +767,7 @@ Condition::Condition(char *debugName)
 {
     name = debugName;
     waitQueue = new List<Semaphore *>;
+    PROFILE_INIT("Condition", debugName);
 }
 
 //----------------------------------------------------------------------
@@ -267,12 +806,61 @@ void Condition::Wait(Lock *conditionLock)
 
     ASSERT(conditionLock->IsHeldByCurrentThread());
 
+    PROFILE_START(start);
     waiter = new Semaphore("condition", 0);
     waitQueue->Append(waiter);
     conditionLock->Release();
     waiter->P();
     conditionLock->Acquire();
     delete waiter;
+    PROFILE_ACQUIRED(TRUE, start);
+}
+
+//----------------------------------------------------------------------
+// Condition::Wait (with a timeout)
+// 	Same as Wait, but stop waiting for a signal after "timeout"
+//	ticks.  Either way, we have the lock again when we return.
+//
+//	If a signal comes in just as we time out, we count it as
+//	received, so it isn't lost.
+//
+//	Returns TRUE if we were signalled, FALSE if we timed out.
+//----------------------------------------------------------------------
+
+bool Condition::Wait(Lock *conditionLock, int timeout)
+{
+    Semaphore *waiter;
+    bool signalled;
+
+    ASSERT(conditionLock->IsHeldByCurrentThread());
+
+    PROFILE_START(start);
+    waiter = new Semaphore("condition", 0);
+    waitQueue->Append(waiter);
+    conditionLock->Release();
+    signalled = waiter->P(timeout);
+    conditionLock->Acquire();
+    if (!signalled)
+    {
+        if (waitQueue->IsInList(waiter))
+        {
+            waitQueue->Remove(waiter); // no one will signal us now
+        }
+        else
+        {
+            signalled = TRUE; // signalled after all
+        }
+    }
+    delete waiter;
+    if (signalled)
+    {
+        PROFILE_ACQUIRED(TRUE, start);
+    }
+    else
+    {
+        PROFILE_GAVE_UP(start);
+    }
+    return signalled;
 }
 
 //----------------------------------------------------------------------
@@ -317,3 +905,232 @@ void Condition::Broadcast(Lock *conditionLock)
         Signal(conditionLock);
     }
 }
+
+//----------------------------------------------------------------------
+// RWLock::RWLock
+// 	Initialize a readers/writer lock, so that it can be used for
+//	synchronization.  Initially, no one holds it.
+//
+//	"debugName" is an arbitrary name, useful for debugging.
+//----------------------------------------------------------------------
+
+RWLock::RWLock(char *debugName)
+{
+    name = debugName;
+    lock = new Lock(debugName);
+    okToRead = new Condition(debugName);
+    okToWrite = new Condition(debugName);
+    activeReaders = 0;
+    waitingWriters = 0;
+    writer = NULL;
+}
+
+//----------------------------------------------------------------------
+// RWLock::~RWLock
+// 	Deallocate a readers/writer lock.  Assume no one holds it or is
+//	waiting for it.
+//----------------------------------------------------------------------
+
+RWLock::~RWLock()
+{
+    ASSERT(activeReaders == 0 && writer == NULL && waitingWriters == 0);
+    delete okToWrite;
+    delete okToRead;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// RWLock::AcquireRead
+// 	Wait until no thread is writing or waiting to write, then start
+//	reading.
+//----------------------------------------------------------------------
+
+void RWLock::AcquireRead()
+{
+    lock->Acquire();
+    while (writer != NULL || waitingWriters > 0)
+    {
+        okToRead->Wait(lock);
+    }
+    activeReaders++;
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// RWLock::ReleaseRead
+// 	Stop reading.  If we were the last reader, let a writer in.
+//----------------------------------------------------------------------
+
+void RWLock::ReleaseRead()
+{
+    lock->Acquire();
+    ASSERT(activeReaders > 0);
+    if (--activeReaders == 0 && waitingWriters > 0)
+    {
+        okToWrite->Signal(lock);
+    }
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// RWLock::AcquireWrite
+// 	Wait until no thread is reading or writing, then start writing.
+//	While we wait, no new readers are let in.
+//----------------------------------------------------------------------
+
+void RWLock::AcquireWrite()
+{
+    lock->Acquire();
+    waitingWriters++;
+    while (writer != NULL || activeReaders > 0)
+    {
+        okToWrite->Wait(lock);
+    }
+    waitingWriters--;
+    writer = kernel->currentThread;
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// RWLock::ReleaseWrite
+// 	Stop writing.  Let the next writer in, if there is one; otherwise
+//	let in all the readers that were waiting.
+//----------------------------------------------------------------------
+
+void RWLock::ReleaseWrite()
+{
+    lock->Acquire();
+    ASSERT(IsWriteHeldByCurrentThread());
+    writer = NULL;
+    if (waitingWriters > 0)
+    {
+        okToWrite->Signal(lock);
+    }
+    else
+    {
+        okToRead->Broadcast(lock);
+    }
+    lock->Release();
+}
+
+bool RWLock::IsWriteHeldByCurrentThread()
+{
+    return writer == kernel->currentThread;
+}
+
+//----------------------------------------------------------------------
+// RWLock::SelfTest, RWLockWriter, RWLockReader
+// 	Test writer preference.  While we hold the lock for reading, a
+//	writer starts waiting for it, and then another reader.  The
+//	reader must not get in ahead of the writer, even though the lock
+//	is only held for reading.
+//----------------------------------------------------------------------
+
+static char rwOrder[3];      // who got the lock, in order
+static int rwNumOrdered;
+static Semaphore *rwLockDone; // V'ed by each thread as it finishes
+
+static void
+RWLockWriter(RWLock *rwLock)
+{
+    rwLock->AcquireWrite();
+    rwOrder[rwNumOrdered++] = 'W';
+    rwLock->ReleaseWrite();
+    rwLockDone->V();
+}
+
+static void
+RWLockReader(RWLock *rwLock)
+{
+    rwLock->AcquireRead();
+    rwOrder[rwNumOrdered++] = 'R';
+    rwLock->ReleaseRead();
+    rwLockDone->V();
+}
+
+void RWLock::SelfTest()
+{
+    Thread *t;
+
+    rwNumOrdered = 0;
+    rwLockDone = new Semaphore("rwlock", 0);
+
+    AcquireRead();
+    t = new Thread("writer");
+    t->Fork((VoidFunctionPtr)RWLockWriter, (void *)this);
+    while (waitingWriters == 0)
+    {
+        kernel->currentThread->Yield(); // let it wait for us
+    }
+    t = new Thread("reader");
+    t->Fork((VoidFunctionPtr)RWLockReader, (void *)this);
+    for (int i = 0; i < 3; i++)
+    {
+        kernel->currentThread->Yield(); // give it a chance to cut in
+    }
+    ASSERT(rwNumOrdered == 0);
+    ReleaseRead();
+
+    rwLockDone->P();
+    rwLockDone->P();
+    ASSERT(rwNumOrdered == 2 && rwOrder[0] == 'W' && rwOrder[1] == 'R');
+    delete rwLockDone;
+}
+
+//----------------------------------------------------------------------
+// LockBenchmark
+// 	Time how long it takes the host to acquire and release each kind
+//	of synchronization object when no other thread wants it, and how
+//	much simulated time that takes.  The semaphore has to disable
+//	interrupts on every P and V, and re-enabling them advances the
+//	clock; the lock fast paths don't touch the interrupt level.
+//
+//	"numPairs" is how many times to acquire and release each object.
+//----------------------------------------------------------------------
+
+void LockBenchmark(int numPairs)
+{
+    Semaphore *semaphore = new Semaphore("benchmark", 1);
+    Lock *lock = new Lock("benchmark");
+    RWLock *rwLock = new RWLock("benchmark");
+
+    for (int which = 0; which < 4; which++)
+    {
+        static char *kinds[] = {"Semaphore P/V", "Lock Acquire/Release",
+                                "RWLock AcquireRead/ReleaseRead",
+                                "RWLock AcquireWrite/ReleaseWrite"};
+        int ticks = kernel->stats->totalTicks;
+        double start = HostTime(), elapsed;
+
+        for (int i = 0; i < numPairs; i++)
+        {
+            switch (which)
+            {
+            case 0:
+                semaphore->P();
+                semaphore->V();
+                break;
+            case 1:
+                lock->Acquire();
+                lock->Release();
+                break;
+            case 2:
+                rwLock->AcquireRead();
+                rwLock->ReleaseRead();
+                break;
+            case 3:
+                rwLock->AcquireWrite();
+                rwLock->ReleaseWrite();
+                break;
+            }
+        }
+        elapsed = HostTime() - start;
+        cout << "Lock benchmark: " << kinds[which] << ": "
+             << (int)(elapsed > 0 ? numPairs / elapsed : 0)
+             << " pairs per second, "
+             << kernel->stats->totalTicks - ticks << " ticks\n";
+    }
+    delete rwLock;
+    delete lock;
+    delete semaphore;
+}
@@ -1,11 +1,9 @@
 // synch.h
 //	Data structures for synchronizing threads.
 //
-//	Three kinds of synchronization are defined here: semaphores,
-//	locks, and condition variables.  The implementation for
-//	semaphores is given; for the latter two, only the procedure
-//	interface is given -- they are to be implemented as part of
-//	the first assignment.
+//	Four kinds of synchronization are defined here: semaphores,
+//	locks, condition variables, and readers/writer locks.  All four
+//	are implemented in synch.cc.
 //
 //	Note that all the synchronization objects take a "name" as
 //	part of the initialization.  This is solely for debugging purposes.
@@ -21,6 +19,7 @@
 #include "thread.h"
 #include "list.h"
 #include "main.h"
+#include "synchprof.h"
 
 // The following class defines a "semaphore" whose value is a non-negative
 // integer.  The semaphore has only two operations P() and V():
@@ -46,13 +45,20 @@ public:
 
     void P();        // these are the only operations on a semaphore
     void V();        // they are both *atomic*
+
+    bool P(int timeout); // P, but give up after "timeout" ticks;
+                         // TRUE if we decremented the value
+    bool TryP();         // P, but only if we needn't wait
     void SelfTest(); // test routine for semaphore implementation
 
 private:
     char *name; // useful for debugging
     int value;  // semaphore value, always >= 0
-    List<Thread *> *queue;
+    ThreadQueue *queue;
     // threads waiting in P() for the value to be > 0
+#ifdef SYNCH_PROFILE
+    SynchProfile *profile; // contention on semaphores with our name
+#endif
 };
 
 // The following class defines a "lock".  A lock can be BUSY or FREE.
@@ -66,6 +72,14 @@ private:
 // In addition, by convention, only the thread that acquired the lock
 // may release it.  As with semaphores, you can't read the lock value
 // (because the value might change immediately after you read it).
+//
+// The thread holding a lock inherits the priority of the threads
+// waiting for it, if that is better than its own, until it releases
+// the lock; see Thread::UpdatePriority.
+//
+// Acquiring a free lock that no one is waiting for, and releasing a
+// lock no one is waiting for, are done without disabling interrupts,
+// so they take no simulated time.
 
 class Lock
 {
@@ -77,16 +91,47 @@ public:
     void Acquire(); // these are the only operations on a lock
     void Release(); // they are both *atomic*
 
+    bool Acquire(int timeout); // Acquire, but give up after "timeout"
+                               // ticks; TRUE if we got the lock
+    bool TryAcquire();         // Acquire, but only if the lock is free
+
     bool IsHeldByCurrentThread();
     // return true if the current thread
     // holds this lock.
 
-    // Note: SelfTest routine provided by SynchList
+    Thread *getHolder() { return lockHolder; }
+    int DonatedPriority(int priority);
+    // the best of "priority" and the priorities
+    // of the threads waiting for the lock
+    Lock *getNextHeld() { return nextHeld; }
+    void setNextHeld(Lock *l) { nextHeld = l; }
+    // next lock held by lockHolder
+
+    void SelfTest(); // test priority inheritance
+    // Note: other SelfTest routines provided by SynchList
 
 private:
     char *name;           // debugging assist
     Thread *lockHolder;   // thread currently holding lock
-    Semaphore *semaphore; // we use a semaphore to implement lock
+    ThreadQueue *queue;   // threads sleeping until the lock is free
+    int waitingTickets;   // tickets lent to lockHolder by the threads
+                          // waiting for the lock
+    List<Thread *> *waiters; // threads waiting for the lock (asleep,
+                             // or woken up but not yet run), whose
+                             // priorities lockHolder inherits
+    Lock *nextHeld;       // next lock held by the same thread
+
+    int StartWaiting();         // we have to wait: lend lockHolder
+                                // our tickets and priority
+    void StopWaiting(int lent); // we're done waiting, one way or the
+                                // other
+    void Take();                // we've got the lock
+#ifdef SYNCH_PROFILE
+    SynchProfile *profile; // contention on locks with our name
+    int acquiredAt;        // when lockHolder got the lock
+
+    void Profile(bool contended, int start); // record an acquisition
+#endif
 };
 
 // The following class defines a "condition variable".  A condition
@@ -139,8 +184,72 @@ public:
                                          // these operations
                                          // SelfTest routine provided by SyncLists
 
+    bool Wait(Lock *conditionLock, int timeout);
+                                         // Wait, but stop waiting after
+                                         // "timeout" ticks; TRUE if we
+                                         // were signalled
+
 private:
     char *name;
     List<Semaphore *> *waitQueue; // list of waiting threads
+#ifdef SYNCH_PROFILE
+    SynchProfile *profile; // waits on conditions with our name
+#endif
 };
+
+// The following class defines a "readers/writer lock".  Any number of
+// threads may hold it for reading at the same time, or one thread may
+// hold it for writing:
+//
+//	AcquireRead -- wait until no thread holds the lock for writing,
+//		or is waiting to, then hold it for reading
+//
+//	ReleaseRead -- stop reading, waking up a waiting writer if we
+//		were the last reader
+//
+//	AcquireWrite -- wait until no thread holds the lock at all, then
+//		hold it for writing
+//
+//	ReleaseWrite -- stop writing, waking up the next writer if there
+//		is one, or else all the waiting readers
+//
+// Writers are preferred: once a writer is waiting, new readers wait
+// behind it, so a steady stream of readers cannot starve the writers.
+// (A steady stream of writers can starve the readers instead.)
+//
+// It is implemented as a monitor, with a lock and two condition
+// variables; when the lock isn't contended, acquiring or releasing it
+// for reading is just two Lock fast paths.
+
+class RWLock
+{
+public:
+    RWLock(char *debugName); // initialize lock to be FREE
+    ~RWLock();               // deallocate lock
+    char *getName() { return name; }
+
+    void AcquireRead();  // hold the lock, along with other readers
+    void ReleaseRead();
+    void AcquireWrite(); // hold the lock alone
+    void ReleaseWrite(); // only the writer may release the lock
+
+    bool IsWriteHeldByCurrentThread(); // true if the current thread
+                                       // holds this lock for writing
+
+    void SelfTest(); // test writer preference
+
+private:
+    char *name;
+    Lock *lock;           // protects the fields below
+    Condition *okToRead;  // signalled when there is no writer,
+                          // active or waiting
+    Condition *okToWrite; // signalled when the lock is free
+    int activeReaders;    // number of threads reading
+    int waitingWriters;   // number of threads waiting to write
+    Thread *writer;       // thread writing, or NULL
+};
+
+// time acquire/release pairs of the synchronization objects on the host
+extern void LockBenchmark(int numPairs);
+
 #endif // SYNCH_H
@@ -0,0 +1,224 @@
+// synchprof.cc
+//	Routines to profile contention on the synchronization objects.
+//	See synchprof.h.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "synchprof.h"
+#include "main.h"
+
+#ifdef SYNCH_PROFILE
+
+// Every profile, most recently created first.
+static SynchProfile *allProfiles = NULL;
+
+// Make our own copy of a name, since the thread or object it came from
+// may go away before we print it.
+static char *
+CopyName(const char *name)
+{
+    char *copy;
+
+    copy = new char[strlen(name) + 1];
+    strcpy(copy, name);
+    return copy;
+}
+
+//----------------------------------------------------------------------
+// SynchProfile::SynchProfile
+// 	Initialize an empty profile, and add it to the list of profiles.
+//----------------------------------------------------------------------
+
+SynchProfile::SynchProfile(const char *profileKind, const char *profileName)
+{
+    kind = profileKind;
+    name = CopyName(profileName);
+    numAcquires = numContended = numGaveUp = 0;
+    totalWait = maxWait = 0;
+    totalHold = maxHold = 0;
+    numWaiters = 0;
+    next = allProfiles;
+    allProfiles = this;
+}
+
+//----------------------------------------------------------------------
+// SynchProfile::Find
+// 	Return the profile of the objects of kind "kind" named "name".
+//----------------------------------------------------------------------
+
+SynchProfile *
+SynchProfile::Find(const char *kind, const char *name)
+{
+    if (name == NULL)
+    {
+        name = "(unnamed)";
+    }
+    for (SynchProfile *p = allProfiles; p != NULL; p = p->next)
+    {
+        if (strcmp(p->kind, kind) == 0 && strcmp(p->name, name) == 0)
+        {
+            return p;
+        }
+    }
+    return new SynchProfile(kind, name);
+}
+
+//----------------------------------------------------------------------
+// SynchProfile::Acquired, SynchProfile::GaveUp, SynchProfile::Held
+// 	Record an acquisition, a wait that timed out, or how long a
+//	lock was held.
+//----------------------------------------------------------------------
+
+void
+SynchProfile::Acquired(bool contended, int waitTicks)
+{
+    numAcquires++;
+    if (contended)
+    {
+        numContended++;
+        Waited(waitTicks);
+    }
+}
+
+void
+SynchProfile::GaveUp(int waitTicks)
+{
+    numGaveUp++;
+    numContended++;
+    Waited(waitTicks);
+}
+
+void
+SynchProfile::Held(int holdTicks)
+{
+    totalHold += holdTicks;
+    if (holdTicks > maxHold)
+    {
+        maxHold = holdTicks;
+    }
+}
+
+//----------------------------------------------------------------------
+// SynchProfile::Waited
+// 	Add a wait by the current thread to the totals, and to the
+//	thread's own total if we have room for it.
+//----------------------------------------------------------------------
+
+void
+SynchProfile::Waited(int waitTicks)
+{
+    char *threadName = kernel->currentThread->getName();
+    int i;
+
+    totalWait += waitTicks;
+    if (waitTicks > maxWait)
+    {
+        maxWait = waitTicks;
+    }
+    for (i = 0; i < numWaiters; i++)
+    {
+        if (strcmp(waiters[i].name, threadName) == 0)
+        {
+            break;
+        }
+    }
+    if (i == numWaiters)
+    {
+        if (numWaiters == MaxProfileWaiters)
+        {
+            return; // no room
+        }
+        waiters[numWaiters].name = CopyName(threadName);
+        waiters[numWaiters].ticks = 0;
+        numWaiters++;
+    }
+    waiters[i].ticks += waitTicks;
+}
+
+//----------------------------------------------------------------------
+// SynchProfile::PrintAll
+// 	Print the profile of every object that was ever acquired or
+//	waited for, those with the most ticks spent waiting first, each
+//	with the threads that waited the longest for it.
+//----------------------------------------------------------------------
+
+void
+SynchProfile::PrintAll()
+{
+    SynchProfile **sorted;
+    int num = 0;
+
+    for (SynchProfile *p = allProfiles; p != NULL; p = p->next)
+    {
+        num++;
+    }
+    sorted = new SynchProfile *[num];
+    num = 0;
+    for (SynchProfile *p = allProfiles; p != NULL; p = p->next)
+    {
+        int i;
+
+        if (p->numAcquires == 0 && p->numGaveUp == 0)
+        {
+            continue;
+        }
+        for (i = num; i > 0 && sorted[i - 1]->totalWait < p->totalWait; i--)
+        {
+            sorted[i] = sorted[i - 1];
+        }
+        sorted[i] = p;
+        num++;
+    }
+
+    cout << "Contention profile, most waited for first:\n";
+    for (int i = 0; i < num; i++)
+    {
+        SynchProfile *p = sorted[i];
+
+        cout << p->kind << " " << p->name << ": acquired " << p->numAcquires
+             << ", contended " << p->numContended;
+        if (p->numGaveUp > 0)
+        {
+            cout << " (" << p->numGaveUp << " timed out)";
+        }
+        cout << ", wait ticks " << p->totalWait << " (max " << p->maxWait
+             << ")";
+        if (p->totalHold > 0)
+        {
+            cout << ", hold ticks " << p->totalHold << " (max "
+                 << p->maxHold << ")";
+        }
+        cout << "\n";
+
+        // selection sort the waiters, the longest first
+        for (int j = 0; j < p->numWaiters && j < ProfileTopWaiters; j++)
+        {
+            int top = j;
+
+            for (int k = j + 1; k < p->numWaiters; k++)
+            {
+                if (p->waiters[k].ticks > p->waiters[top].ticks)
+                {
+                    top = k;
+                }
+            }
+            if (top != j)
+            {
+                char *name = p->waiters[j].name;
+                int ticks = p->waiters[j].ticks;
+
+                p->waiters[j] = p->waiters[top];
+                p->waiters[top].name = name;
+                p->waiters[top].ticks = ticks;
+            }
+            cout << "    " << p->waiters[j].name << " waited "
+                 << p->waiters[j].ticks << " ticks\n";
+        }
+    }
+    delete[] sorted;
+}
+
+#endif // SYNCH_PROFILE
@@ -0,0 +1,126 @@
+// synchprof.h
+//	Data structures for profiling contention on the synchronization
+//	objects: how often each semaphore, lock and condition variable
+//	was acquired, how often a thread had to wait for it, for how
+//	long, and which threads waited the most.
+//
+//	The profiler is only compiled in when SYNCH_PROFILE is defined
+//	(see Makefile.common).  The synchronization routines call it
+//	through the PROFILE_ macros below, which, like DEBUG, expand to
+//	nothing when it isn't.
+//
+//	Objects of the same kind with the same name share a profile, so
+//	that, for instance, all the per-file locks, or all the semaphores
+//	Condition::Wait creates, are added together; and so that the
+//	numbers outlive the objects.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SYNCHPROF_H
+#define SYNCHPROF_H
+
+#include "copyright.h"
+
+//----------------------------------------------------------------------
+// PROFILE_INIT
+//	Set "profile" to the profile for objects of this kind and name.
+//
+// PROFILE_START, PROFILE_CONTENDED
+//	Declare "start", the time the current thread started to wait,
+//	and "contended", whether it will really have to ("busy").
+//
+// PROFILE_ACQUIRED, PROFILE_GAVE_UP
+//	Record in "profile" that the current thread got the object, or
+//	stopped waiting for it, after waiting since "start".
+//
+// PROFILE_LOCKED, PROFILE_UNLOCKED
+//	The same for a Lock, which also keeps track of how long it was
+//	held (see Lock::Profile).
+//
+//	These use the kernel, so they can only be used in files that
+//	include main.h.
+//----------------------------------------------------------------------
+
+#ifdef SYNCH_PROFILE
+
+#define PROFILE_INIT(kind, name) profile = SynchProfile::Find(kind, name)
+#define PROFILE_START(start) int start = kernel->stats->totalTicks
+#define PROFILE_CONTENDED(contended, busy) bool contended = (busy)
+#define PROFILE_ACQUIRED(contended, start) \
+    profile->Acquired(contended, kernel->stats->totalTicks - (start))
+#define PROFILE_GAVE_UP(start) \
+    profile->GaveUp(kernel->stats->totalTicks - (start))
+#define PROFILE_LOCKED(contended, start) Profile(contended, start)
+#define PROFILE_UNLOCKED() \
+    profile->Held(kernel->stats->totalTicks - acquiredAt)
+
+#else
+
+#define PROFILE_INIT(kind, name)
+#define PROFILE_START(start)
+#define PROFILE_CONTENDED(contended, busy)
+#define PROFILE_ACQUIRED(contended, start)
+#define PROFILE_GAVE_UP(start)
+#define PROFILE_LOCKED(contended, start)
+#define PROFILE_UNLOCKED()
+
+#endif // SYNCH_PROFILE
+
+#ifdef SYNCH_PROFILE
+
+// Number of threads we keep track of, for each profile; once that
+// many have waited, the waiting times of any others are only added
+// to the totals.
+const int MaxProfileWaiters = 8;
+
+// Number of threads listed for each profile in the report.
+const int ProfileTopWaiters = 3;
+
+// The following class defines the profile of a set of synchronization
+// objects of the same kind and name.
+
+class SynchProfile
+{
+public:
+    static SynchProfile *Find(const char *kind, const char *name);
+                                // return the profile for objects
+                                // of this kind and name, creating it
+                                // if need be
+
+    void Acquired(bool contended, int waitTicks);
+                                // the current thread got the object,
+                                // after waiting if "contended"
+    void GaveUp(int waitTicks); // the current thread stopped waiting
+                                // without getting it (timed out)
+    void Held(int holdTicks);   // a lock was released
+
+    static void PrintAll();     // print the profiles, those waited
+                                // for the longest first
+
+private:
+    SynchProfile(const char *kind, const char *name);
+
+    void Waited(int waitTicks); // charge the wait to the current thread
+
+    const char *kind;           // "Semaphore", "Lock" or "Condition"
+    char *name;
+    int numAcquires;            // times the object was acquired
+    int numContended;           // times some thread had to wait
+    int numGaveUp;              // times a thread gave up waiting
+    int totalWait, maxWait;     // ticks spent waiting
+    int totalHold, maxHold;     // ticks locks were held
+
+    struct {                    // the threads that waited
+        char *name;
+        int ticks;
+    } waiters[MaxProfileWaiters];
+    int numWaiters;
+
+    SynchProfile *next;         // all the profiles
+};
+
+#endif // SYNCH_PROFILE
+
+#endif // SYNCHPROF_H
@@ -33,6 +33,7 @@ const int STACK_FENCEPOST = 0xdedbeef;
 //	"threadName" is an arbitrary string, useful for debugging.
 //----------------------------------------------------------------------
 
+Slab Thread::slab = {"Thread", sizeof(Thread)};
 int Thread::nextThreadID = 0;
 
 Thread::Thread(char *threadName)
@@ -42,6 +43,24 @@ Thread::Thread(char *threadName)
     stackTop = NULL;
     stack = NULL;
     status = JUST_CREATED;
+    burstTime = 0;
+    burstStart = kernel->stats->totalTicks;
+    burstSoFar = 0;
+    numBursts = 0;
+    predictedTotal = actualTotal = errorTotal = 0;
+    priority = basePriority = 0;
+    heldLocks = waitingFor = NULL;
+    quantum = quantumUsed = 0;
+    wakeTime = 0;
+    tickets = DefaultTickets;
+    lentTickets = 0;
+    pass = 0;
+    vruntime = 0;
+    realTime = NULL;
+    heapIndex = -1;
+    level = 0;
+    stats = new ThreadStats(threadName, threadID);
+    kernel->scheduler->Register(stats);
     for (int i = 0; i < MachineStateSize; i++)
     {
         machineState[i] = NULL; // not strictly necessary, since
@@ -53,6 +72,31 @@ Thread::Thread(char *threadName)
 #endif
 }
 
+//----------------------------------------------------------------------
+// ThreadStats::ThreadStats
+// 	Start the history of a thread that has just been created.
+//
+//	We keep our own copy of the thread's name, since the history
+//	outlives the thread.
+//----------------------------------------------------------------------
+
+ThreadStats::ThreadStats(char *threadName, int id)
+{
+    name = new char[strlen(threadName) + 1];
+    strcpy(name, threadName);
+    threadID = id;
+    createTime = readySince = kernel->stats->totalTicks;
+    firstRunTime = finishTime = -1;
+    waitTotal = runTotal = 0;
+    numPreemptions = numYields = 0;
+    next = NULL;
+}
+
+ThreadStats::~ThreadStats()
+{
+    delete[] name;
+}
+
 //----------------------------------------------------------------------
 // Thread::~Thread
 // 	De-allocate a thread.
@@ -71,7 +115,12 @@ Thread::~Thread()
 
     ASSERT(this != kernel->currentThread);
     if (stack != NULL)
-        DeallocBoundedArray((char *)stack, StackSize * sizeof(int));
+        StackPool::Put(stack);
+    delete realTime;
+#ifdef USER_PROGRAM
+    if (space != NULL)
+        delete space; // give the frames back to everyone else
+#endif
 }
 
 //----------------------------------------------------------------------
@@ -179,6 +228,7 @@ void Thread::Finish()
 
     DEBUG(dbgThread, "Finishing thread: " << name);
 
+    stats->finishTime = kernel->stats->totalTicks;
     Sleep(TRUE); // invokes SWITCH
     // not reached
 }
@@ -189,7 +239,9 @@ void Thread::Finish()
 //	If so, put the thread on the end of the ready list, so that
 //	it will eventually be re-scheduled.
 //
-//	NOTE: returns immediately if no other thread on the ready queue.
+//	NOTE: returns immediately if no other thread on the ready queue,
+//	unless the EDF scheduler has throttled us, in which case we
+//	sleep until our next period.
 //	Otherwise returns when the thread eventually works its way
 //	to the front of the ready list and gets re-scheduled.
 //
@@ -205,6 +257,7 @@ void Thread::Yield()
 {
     Thread *nextThread;
     IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    bool preempted = kernel->interrupt->TakePreemption();
 
     ASSERT(this == kernel->currentThread);
 
@@ -213,9 +266,33 @@ void Thread::Yield()
     nextThread = kernel->scheduler->FindNextToRun();
     if (nextThread != NULL)
     {
+        if (preempted)
+            stats->numPreemptions++;
+        else
+            stats->numYields++;
         kernel->scheduler->ReadyToRun(this);
         kernel->scheduler->Run(nextThread, FALSE);
     }
+    else if (realTime != NULL && realTime->throttled)
+    {
+        Sleep(FALSE); // out of budget: idle until our next period
+    }
+    (void)kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Thread::WaitForNextPeriod
+// 	Called by a periodic real-time thread when it has finished the
+//	job for this period.  Returns when the next period starts.
+//----------------------------------------------------------------------
+
+void Thread::WaitForNextPeriod()
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    ASSERT(this == kernel->currentThread);
+    ASSERT(realTime != NULL);
+    kernel->scheduler->EndJob(this);
     (void)kernel->interrupt->SetLevel(oldLevel);
 }
 
@@ -249,6 +326,7 @@ void Thread::Sleep(bool finishing)
     DEBUG(dbgThread, "Sleeping thread: " << name);
 
     status = BLOCKED;
+    kernel->scheduler->Stop(this); // don't bill us for time spent idle
     while ((nextThread = kernel->scheduler->FindNextToRun()) == NULL)
         kernel->interrupt->Idle(); // no one to run, wait for an interrupt
 
@@ -256,6 +334,182 @@ void Thread::Sleep(bool finishing)
     kernel->scheduler->Run(nextThread, finishing);
 }
 
+//----------------------------------------------------------------------
+// Thread::setPriority
+//	Change the thread's own priority.  If that changes the priority
+//	it is scheduled by (it may be inheriting a better one), and the
+//	thread is waiting on the ready list, it has to move to the back
+//	of the queue for its new priority.
+//----------------------------------------------------------------------
+
+void Thread::setPriority(int t)
+{
+    IntStatus oldLevel;
+
+    if (status != READY && heldLocks == NULL && waitingFor == NULL)
+    {
+        priority = basePriority = t; // nothing else to do
+        return;
+    }
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    basePriority = t;
+    UpdatePriority();
+    (void)kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Thread::UpdatePriority
+//	Recompute the priority we are scheduled by: the best (lowest) of
+//	our own and those of all the threads waiting for locks we hold.
+//	If it changed and we are waiting for a lock ourselves, the
+//	holder of that lock inherits it in turn, and so on down the
+//	chain, so that no one in it is held up by threads of lower
+//	priority than the one at the end.
+//
+//	Called whenever a thread starts or stops waiting for one of
+//	our locks, and when we acquire or release one.
+//----------------------------------------------------------------------
+
+void Thread::UpdatePriority()
+{
+    int best = basePriority;
+
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+    for (Lock *lock = heldLocks; lock != NULL; lock = lock->getNextHeld())
+    {
+        best = lock->DonatedPriority(best);
+    }
+    if (best == priority)
+    {
+        return;
+    }
+    DEBUG(dbgThread, "Priority of " << name << " goes from " << priority
+                                    << " to " << best);
+    if (status == READY) // move us on the ready list
+    {
+        kernel->scheduler->Remove(this);
+        priority = best;
+        kernel->scheduler->ReadyToRun(this);
+    }
+    else
+    {
+        priority = best;
+    }
+    if (waitingFor != NULL && waitingFor->getHolder() != NULL)
+    {
+        waitingFor->getHolder()->UpdatePriority();
+    }
+}
+
+//----------------------------------------------------------------------
+// Thread::AddHeldLock, Thread::RemoveHeldLock
+//	Keep track of the locks we hold, so that we can inherit the
+//	priorities of the threads waiting for them.
+//----------------------------------------------------------------------
+
+void Thread::AddHeldLock(Lock *lock)
+{
+    lock->setNextHeld(heldLocks);
+    heldLocks = lock;
+}
+
+void Thread::RemoveHeldLock(Lock *lock)
+{
+    Lock *prev = NULL, *ptr = heldLocks;
+
+    while (ptr != lock)
+    {
+        ASSERT(ptr != NULL); // we must hold it
+        prev = ptr;
+        ptr = ptr->getNextHeld();
+    }
+    if (prev == NULL)
+    {
+        heldLocks = lock->getNextHeld();
+    }
+    else
+    {
+        prev->setNextHeld(lock->getNextHeld());
+    }
+    lock->setNextHeld(NULL);
+}
+
+//----------------------------------------------------------------------
+// Thread::StartBurst
+//	Called by the scheduler when this thread is given the CPU.
+//	Start timing the next piece of the current CPU burst.
+//----------------------------------------------------------------------
+
+void Thread::StartBurst()
+{
+    burstStart = kernel->stats->totalTicks;
+}
+
+//----------------------------------------------------------------------
+// Thread::StopBurst
+//	Called by the scheduler when this thread gives up the CPU.
+//	Calling it again before the thread next runs does nothing.
+//
+//	If the thread was only preempted (it is still READY), the CPU
+//	burst isn't over yet, so we just add up how long it has run.
+//	If it blocked or finished, the burst is over, and we use its
+//	length to predict the next one, by exponential averaging:
+//
+//		next = alpha * actual + (1 - alpha) * predicted
+//----------------------------------------------------------------------
+
+void Thread::StopBurst()
+{
+    int actual;
+
+    if (burstStart < 0)
+        return; // already stopped
+    burstSoFar += kernel->stats->totalTicks - burstStart;
+    burstStart = -1;
+    if (status != BLOCKED)
+        return;
+
+    actual = burstSoFar;
+    DEBUG(dbgThread, "CPU burst of " << name << ": predicted " << burstTime
+                                     << ", actual " << actual);
+    numBursts++;
+    predictedTotal += burstTime;
+    actualTotal += actual;
+    errorTotal += (actual > burstTime) ? actual - burstTime : burstTime - actual;
+
+    burstTime = (BurstAlpha * actual + (100 - BurstAlpha) * burstTime) / 100;
+    burstSoFar = 0;
+}
+
+//----------------------------------------------------------------------
+// Thread::getRemainingBurst
+//	Return how much of the predicted CPU burst is left, counting
+//	the time we've been running since we last got the CPU.
+//----------------------------------------------------------------------
+
+int Thread::getRemainingBurst()
+{
+    int used = burstSoFar;
+
+    if (status == RUNNING)
+        used += kernel->stats->totalTicks - burstStart;
+    return (used < burstTime) ? burstTime - used : 0;
+}
+
+//----------------------------------------------------------------------
+// Thread::PrintBursts
+//	Print how well we predicted this thread's CPU bursts.
+//----------------------------------------------------------------------
+
+void Thread::PrintBursts()
+{
+    cout << "Thread " << name << ": " << numBursts << " CPU bursts, predicted "
+         << predictedTotal << " ticks, actual " << actualTotal << " ticks";
+    if (numBursts > 0)
+        cout << ", mean error " << errorTotal / numBursts << " ticks";
+    cout << "\n";
+}
+
 //----------------------------------------------------------------------
 // ThreadBegin, ThreadFinish,  ThreadPrint
 //	Dummy functions because C++ does not (easily) allow pointers to member
@@ -309,7 +563,7 @@ PLabelToAddr(void *plabel)
 
 void Thread::StackAllocate(VoidFunctionPtr func, void *arg)
 {
-    stack = (int *)AllocBoundedArray(StackSize * sizeof(int));
+    stack = StackPool::Get();
 
 #ifdef PARISC
     // HP stack works from low addresses to high addresses
@@ -364,6 +618,72 @@ void Thread::StackAllocate(VoidFunctionPtr func, void *arg)
 #endif
 }
 
+//----------------------------------------------------------------------
+// StackPool::Get
+// 	Return a stack for a new thread, from the pool if there's one
+//	there.
+//----------------------------------------------------------------------
+
+int *StackPool::free = NULL;
+int StackPool::numFree = 0;
+int StackPool::maxFree = DefaultStackPoolSize;
+int StackPool::numHits = 0;
+int StackPool::numMisses = 0;
+
+int *StackPool::Get()
+{
+    int *stack;
+
+    if (free == NULL)
+    {
+        numMisses++;
+        return (int *)AllocBoundedArray(StackSize * sizeof(int));
+    }
+    numHits++;
+    stack = free;
+    free = *(int **)stack;
+    numFree--;
+    return stack;
+}
+
+//----------------------------------------------------------------------
+// StackPool::Put
+// 	Take back the stack of a thread that is being deleted.  If the
+//	pool is full, really free it.
+//----------------------------------------------------------------------
+
+void StackPool::Put(int *stack)
+{
+    if (numFree >= maxFree)
+    {
+        DeallocBoundedArray((char *)stack, StackSize * sizeof(int));
+        return;
+    }
+    *(int **)stack = free;
+    free = stack;
+    numFree++;
+}
+
+//----------------------------------------------------------------------
+// StackPool::SetSize
+// 	Set the most stacks the pool may keep, freeing any it has
+//	beyond that.
+//----------------------------------------------------------------------
+
+void StackPool::SetSize(int n)
+{
+    ASSERT(n >= 0);
+    maxFree = n;
+    while (numFree > maxFree)
+    {
+        int *stack = free;
+
+        free = *(int **)stack;
+        numFree--;
+        DeallocBoundedArray((char *)stack, StackSize * sizeof(int));
+    }
+}
+
 #ifdef USER_PROGRAM
 #include "machine.h"
 
@@ -399,23 +719,24 @@ void Thread::RestoreUserState()
 
 #endif
 
+static void ShareSelfTest();
+static void EdfSelfTest();
+
 //----------------------------------------------------------------------
 // SimpleThread
-// 	Loop 5 times, yielding the CPU to another ready thread
-//	each iteration.
+// 	Run for "burst" ticks of CPU time, then finish.
 //
-//	"which" is simply a number identifying the thread, for debugging
-//	purposes.
+//	"burst" is how much work the thread has to do, in units
+//	of SystemTick.
 //----------------------------------------------------------------------
 
 static void
-SimpleThread()
+SimpleThread(int burst)
 {
-    Thread *thread = kernel->currentThread;
-    while (thread->getBurstTime() > 0)
+    while (burst > 0)
     {
-        thread->setBurstTime(thread->getBurstTime() - 1);
-        printf("%s: %d\n", kernel->currentThread->getName(), kernel->currentThread->getBurstTime());
+        burst--;
+        printf("%s: %d\n", kernel->currentThread->getName(), burst);
         // kernel->currentThread->Yield();
         kernel->interrupt->OneTick();
     }
@@ -423,8 +744,11 @@ SimpleThread()
 
 //----------------------------------------------------------------------
 // Thread::SelfTest
-// 	Set up a ping-pong between two threads, by forking a thread
-//	to call SimpleThread, and then calling SimpleThread ourselves.
+// 	Fork three threads with different amounts of work to do, and
+//	let the scheduler decide what order to run them in.
+//
+//	Each thread's guess at its CPU burst starts out as the work
+//	it really has to do, so that SJF picks the shortest one first.
 //----------------------------------------------------------------------
 
 void Thread::SelfTest()
@@ -441,8 +765,283 @@ void Thread::SelfTest()
     {
         t = new Thread(name[i]);
         t->setPriority(priority[i]);
-        t->setBurstTime(burst[i]);
-        t->Fork((VoidFunctionPtr)SimpleThread, (void *)NULL);
+        t->setBurstTime(burst[i] * SystemTick);
+        t->Fork((VoidFunctionPtr)SimpleThread, (void *)burst[i]);
     }
     kernel->currentThread->Yield();
+
+    if (kernel->scheduler->getSchedulerType() == Stride ||
+        kernel->scheduler->getSchedulerType() == Lottery)
+    {
+        ShareSelfTest();
+    }
+    if (kernel->scheduler->getSchedulerType() == EDF)
+    {
+        EdfSelfTest();
+    }
+}
+
+//----------------------------------------------------------------------
+// ShareThread
+// 	Spin until the end of the share test, counting how many ticks
+//	of CPU time we got, then tell the test we're done.
+//
+//	"ticks" is where to count our CPU time.
+//----------------------------------------------------------------------
+
+static int shareTestEnd;        // when the share test is over
+static Semaphore *shareTestDone; // V'ed by each thread when it stops
+
+static void
+ShareThread(int *ticks)
+{
+    while (kernel->stats->totalTicks < shareTestEnd)
+    {
+        *ticks += SystemTick;
+        kernel->interrupt->OneTick();
+    }
+    shareTestDone->V();
+}
+
+//----------------------------------------------------------------------
+// ShareSelfTest
+// 	Check that the proportional-share schedulers give threads CPU
+//	time in proportion to their tickets.  Three threads with 1:2:3
+//	times the default tickets spin for a long time; each one's share
+//	of the CPU must come within ShareTolerance percentage points of
+//	its share of the tickets.
+//
+//	Stride scheduling is exact to within a quantum or so; lottery
+//	scheduling only on average, so it gets a longer run and more
+//	slack.
+//----------------------------------------------------------------------
+
+static void
+ShareSelfTest()
+{
+    const int number = 3;
+    char *name[number] = {"share1", "share2", "share3"};
+    int weight[number] = {1, 2, 3};
+    int ticks[number] = {0, 0, 0};
+    bool lottery = (kernel->scheduler->getSchedulerType() == Lottery);
+    int runTicks = lottery ? 200 * TimerTicks * 10 : 200 * TimerTicks;
+    int shareTolerance = lottery ? 5 : 2;
+    int totalWeight = 0, totalTicks = 0;
+
+    DEBUG(dbgThread, "Entering ShareSelfTest");
+
+    shareTestDone = new Semaphore("share test", 0);
+    shareTestEnd = kernel->stats->totalTicks + runTicks;
+    for (int i = 0; i < number; i++)
+    {
+        Thread *t = new Thread(name[i]);
+
+        t->setTickets(weight[i] * DefaultTickets);
+        t->Fork((VoidFunctionPtr)ShareThread, (void *)&ticks[i]);
+        totalWeight += weight[i];
+    }
+    for (int i = 0; i < number; i++)
+    {
+        shareTestDone->P();
+    }
+    delete shareTestDone;
+
+    for (int i = 0; i < number; i++)
+    {
+        totalTicks += ticks[i];
+    }
+    for (int i = 0; i < number; i++)
+    {
+        int share = 100 * ticks[i] / totalTicks;
+        int expected = 100 * weight[i] / totalWeight;
+
+        cout << name[i] << ": " << weight[i] * DefaultTickets << " tickets, "
+             << ticks[i] << " ticks, " << share << "% of the CPU (expected "
+             << expected << "%)\n";
+        ASSERT(share - expected <= shareTolerance &&
+               expected - share <= shareTolerance);
+    }
+}
+
+//----------------------------------------------------------------------
+// EdfThread, EdfOverrunThread, EdfIdleThread
+// 	A periodic thread for the EDF test: do "work" ticks of CPU time
+//	each period, for EdfJobs periods.  The overrunning thread does
+//	"work" ticks in one go, whatever its budget.  An idle thread
+//	just finishes.
+//	Either way, tell the test we're done, and finish without being
+//	preempted in between, so that the CPU we reserved is given back
+//	by the time the test goes on.
+//----------------------------------------------------------------------
+
+const int EdfJobs = 5;
+static Semaphore *edfDone; // V'ed by each thread as it finishes
+
+static void
+EdfWork(int work)
+{
+    for (int used = 0; used < work; used += SystemTick)
+    {
+        kernel->interrupt->OneTick();
+    }
+}
+
+static void
+EdfThread(int work)
+{
+    for (int job = 0; job < EdfJobs; job++)
+    {
+        EdfWork(work);
+        kernel->currentThread->WaitForNextPeriod();
+    }
+    (void)kernel->interrupt->SetLevel(IntOff);
+    edfDone->V();
+    kernel->currentThread->Finish();
+}
+
+static int edfOverrunEnd; // when the overrunning thread got done
+
+static void
+EdfOverrunThread(int work)
+{
+    EdfWork(work);
+    edfOverrunEnd = kernel->stats->totalTicks;
+    (void)kernel->interrupt->SetLevel(IntOff);
+    edfDone->V();
+    kernel->currentThread->Finish();
+}
+
+static void
+EdfIdleThread(int which)
+{
+    (void)kernel->interrupt->SetLevel(IntOff);
+    edfDone->V();
+    kernel->currentThread->Finish();
+}
+
+//----------------------------------------------------------------------
+// EdfSelfTest
+// 	Check the EDF scheduler:
+//
+//	  - two periodic threads that reserve half the CPU between them,
+//	    and use half their budgets, never miss a deadline;
+//	  - a thread whose density would take the CPU reserved past 1 is
+//	    not admitted;
+//	  - a thread that overruns its budget is throttled until its next
+//	    period, so its job takes more than a period to get done.
+//----------------------------------------------------------------------
+
+static void
+EdfSelfTest()
+{
+    Scheduler *scheduler = kernel->scheduler;
+    Statistics *stats = kernel->stats;
+    int period[2] = {400, 600}, budget[2] = {100, 150};
+    int jobs = stats->numJobs, misses = stats->numDeadlineMisses;
+    Thread *t, *u;
+    bool admitted;
+    int start;
+
+    DEBUG(dbgThread, "Entering EdfSelfTest");
+    edfDone = new Semaphore("edf test", 0);
+
+    // a feasible task set: 100/400 + 150/600 = 0.5
+    for (int i = 0; i < 2; i++)
+    {
+        t = new Thread("periodic");
+        admitted = scheduler->Admit(t, period[i], budget[i], period[i]);
+        ASSERT(admitted);
+        t->Fork((VoidFunctionPtr)EdfThread, (void *)(budget[i] / 2));
+    }
+    edfDone->P();
+    edfDone->P();
+    ASSERT(stats->numJobs - jobs == 2 * EdfJobs);
+    ASSERT(stats->numDeadlineMisses == misses);
+
+    // 60/100 + 50/100 > 1, once the deadlines are taken into account
+    t = new Thread("admitted");
+    u = new Thread("rejected");
+    admitted = scheduler->Admit(t, 200, 60, 100);
+    ASSERT(admitted);
+    admitted = scheduler->Admit(u, 200, 50, 100);
+    ASSERT(!admitted && u->getRealTime() == NULL);
+    t->Fork((VoidFunctionPtr)EdfIdleThread, (void *)0);
+    u->Fork((VoidFunctionPtr)EdfIdleThread, (void *)1);
+    edfDone->P();
+    edfDone->P();
+
+    // an overrun: 150 ticks of work on a budget of 100 per 500 ticks
+    t = new Thread("overrun");
+    admitted = scheduler->Admit(t, 500, 100, 500);
+    ASSERT(admitted);
+    start = stats->totalTicks;
+    t->Fork((VoidFunctionPtr)EdfOverrunThread, (void *)150);
+    edfDone->P();
+    ASSERT(edfOverrunEnd - start >= 500);
+
+    delete edfDone;
+    cout << "EDF: " << 2 * EdfJobs << " periodic jobs with no deadline misses, "
+         << "overrun done after " << edfOverrunEnd - start << " ticks\n";
+}
+
+//----------------------------------------------------------------------
+// ForkBenchmark
+// 	Time how long it takes the host to create and finish threads,
+//	first with the stack pool turned off, then with it on (at the
+//	size given with -stackpool, if any).  Threads are forked eight at
+//	a time, and do nothing but finish, so the time is all spent
+//	creating, switching to and deleting them.
+//
+//	"numThreads" is how many threads to create each time.
+//----------------------------------------------------------------------
+
+static Semaphore *forkBenchDone; // V'ed by each thread as it finishes
+
+static void
+ForkBenchThread(int which)
+{
+    forkBenchDone->V();
+}
+
+void
+ForkBenchmark(int numThreads)
+{
+    const int batch = 8;
+    int poolSize = StackPool::getSize();
+
+    if (poolSize == 0)
+    {
+        poolSize = DefaultStackPoolSize;
+    }
+    forkBenchDone = new Semaphore("fork benchmark", 0);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        int size = (pass == 0) ? 0 : poolSize;
+        int hits = StackPool::numHits;
+        double start;
+
+        StackPool::SetSize(size);
+        start = HostTime();
+        for (int i = 0; i < numThreads; i += batch)
+        {
+            int n = (numThreads - i < batch) ? numThreads - i : batch;
+
+            for (int j = 0; j < n; j++)
+            {
+                Thread *t = new Thread("fork benchmark");
+
+                t->Fork((VoidFunctionPtr)ForkBenchThread, (void *)j);
+            }
+            for (int j = 0; j < n; j++)
+            {
+                forkBenchDone->P();
+            }
+        }
+        kernel->currentThread->Yield(); // let the stragglers finish
+        cout << "Fork benchmark: " << numThreads << " threads, stack pool of "
+             << size << ": " << (int)((HostTime() - start) * 1000000 / numThreads)
+             << " microseconds per thread, " << StackPool::numHits - hits
+             << " stacks reused\n";
+    }
+    delete forkBenchDone;
 }
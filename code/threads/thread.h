@@ -40,12 +40,17 @@
 #include "copyright.h"
 #include "utility.h"
 #include "sysdep.h"
+#include "slab.h"
+#include "list.h"
 
 #ifdef USER_PROGRAM
 #include "machine.h"
 #include "addrspace.h"
 #endif
 
+class RealTimeTask;
+class Lock;
+
 // CPU register state to be saved on context switch.
 // The x86 needs to save only a few registers,
 // SPARC and MIPS needs to save 10 registers,
@@ -59,6 +64,76 @@
 // WATCH OUT IF THIS ISN'T BIG ENOUGH!!!!!
 const int StackSize = (4 * 1024); // in words
 
+// Weight, in percent, given to the most recent CPU burst when predicting
+// the next one (the "alpha" of exponential averaging).
+const int BurstAlpha = 50;
+
+// Tickets a thread holds for the proportional-share schedulers, unless
+// it is given some other number; its CPU share is its tickets over the
+// total held by all the runnable threads.
+const int DefaultTickets = 100;
+
+
+// The following class records the history of a thread, for measuring
+// how well it was scheduled: when it was created, first ran and
+// finished, and how long it spent running and waiting on the ready
+// list.  The scheduler keeps these around after the thread itself has
+// been deleted, and prints them when Nachos halts.
+//
+// The fields are public for notational convenience.
+
+class ThreadStats
+{
+public:
+    ThreadStats(char *threadName, int id); // a thread was just created
+    ~ThreadStats();
+
+    char *name;         // copy of the thread's name
+    int threadID;
+    int createTime;     // when the thread was created
+    int firstRunTime;   // when it first got the CPU, or -1
+    int finishTime;     // when it finished, or -1
+    int readySince;     // when it was last put on the ready list
+    int waitTotal;      // ticks spent on the ready list
+    int runTotal;       // ticks spent running
+    int numPreemptions; // times the timer took the CPU away from it
+    int numYields;      // times it gave the CPU to another thread
+    ThreadStats *next;  // the next thread created, on the
+                        // scheduler's history
+
+    int ResponseTime() { return firstRunTime - createTime; }
+    int TurnaroundTime() { return finishTime - createTime; }
+};
+
+// Most stacks of finished threads the stack pool keeps, unless told
+// otherwise.
+const int DefaultStackPoolSize = 16;
+
+// The following class keeps the stacks of threads that have been
+// deleted, so that the next Fork can reuse one instead of allocating
+// a new one.  Allocating a stack is expensive on the host: besides
+// the memory, it has to protect the guard pages on either side of
+// the stack (see AllocBoundedArray), and unprotect them again when
+// the stack is freed.  Pooled stacks keep their guard pages.
+//
+// Every member is static; there's only one pool.
+
+class StackPool
+{
+public:
+    static int *Get();             // a stack for a new thread
+    static void Put(int *stack);   // a thread is done with its stack
+    static void SetSize(int n);    // keep at most n stacks (0 to
+                                   // turn the pool off)
+    static int getSize() { return maxFree; }
+    static int numHits, numMisses; // Gets from the pool / new stacks
+
+private:
+    static int *free;              // the pooled stacks, linked
+                                   // through their first word
+    static int numFree;
+    static int maxFree;
+};
 
 // Thread state
 enum ThreadStatus
@@ -95,6 +170,16 @@ public:
                              // must not be running when delete
                              // is called
 
+    void *operator new(size_t size) { return slab.Alloc(); }
+    void operator delete(void *p) { slab.Free(p); }
+    // thread control blocks come from a slab
+
+    ListLink<Thread> queueLink; // puts us on the ready list, a
+                                // semaphore's wait queue, or the
+                                // alarm clock's sleep queue; we can
+                                // only be on one of them at a time
+    int heapIndex;              // our slot in the ready heap, or -1
+
     // basic thread operations
 
     void Fork(VoidFunctionPtr func, void *arg);
@@ -108,10 +193,53 @@ public:
 
     void CheckOverflow(); // Check if thread stack has overflowed
     void setStatus(ThreadStatus st) { status = st; }
+    ThreadStatus getStatus() { return status; }
     void setBurstTime(int t) { burstTime = t; }
+                          // initial guess at the length of a CPU burst
     int getBurstTime() { return burstTime; }
-    void setPriority(int t) { priority = t; }
-    int getPriority() { return priority; }
+                          // predicted length of the next CPU burst
+    int getRemainingBurst(); // predicted time left in the current burst
+    void StartBurst();    // we've been given the CPU
+    void StopBurst();     // we've given up the CPU
+    void PrintBursts();   // print predicted vs. actual CPU bursts
+    void setLevel(int l) { level = l; }
+    int getLevel() { return level; } // MLFQ level, 0 is the top
+    void setReadySince(int t) { stats->readySince = t; }
+    int getReadySince() { return stats->readySince; }
+    int getCreateTime() { return stats->createTime; }
+    ThreadStats *getStats() { return stats; } // our scheduling history
+    void setTickets(int t) { tickets = t; }
+    int getTickets() { return tickets; }
+    int getEffectiveTickets() { return tickets + lentTickets; }
+                          // our tickets plus those lent to us
+    void LendTickets(int t) { lentTickets += t; }
+                          // (t < 0 to take them back)
+    void setPass(unsigned int p) { pass = p; }
+    unsigned int getPass() { return pass; } // stride scheduling pass
+    void setRealTime(RealTimeTask *t) { realTime = t; }
+    RealTimeTask *getRealTime() { return realTime; }
+                          // NULL unless we're periodic, see EDF
+    void WaitForNextPeriod(); // our periodic job is done
+    void setVruntime(unsigned int v) { vruntime = v; }
+    unsigned int getVruntime() { return vruntime; }
+                          // CPU time used, weighted by our tickets
+    void setQuantum(int q) { quantum = q; }
+    int getQuantum() { return quantum; } // 0 to use our priority's
+    void setQuantumUsed(int t) { quantumUsed = t; }
+    int getQuantumUsed() { return quantumUsed; }
+    void setWakeTime(int t) { wakeTime = t; }
+    int getWakeTime() { return wakeTime; } // when to wake up, if asleep
+                                           // on the alarm clock
+    void setPriority(int t); // also moves us if we're on the ready list
+    int getPriority() { return priority; } // including any inherited
+    int getBasePriority() { return basePriority; } // our own
+    void UpdatePriority();   // inherit the best priority of the threads
+                             // waiting for our locks, and pass it on to
+                             // the holder of the lock we're waiting for
+    void setWaitingFor(Lock *l) { waitingFor = l; }
+    Lock *getWaitingFor() { return waitingFor; }
+    void AddHeldLock(Lock *lock);    // we've got the lock
+    void RemoveHeldLock(Lock *lock); // we've released it
     char *getName() { return (name); }
     void Print() { cout << name; }
     void SelfTest(); // test whether thread impl is working
@@ -120,6 +248,7 @@ public:
 private:
     // some of the private data for this class is listed above
 
+    static Slab slab;        // where thread control blocks come from
     static int nextThreadID; // 用來產生thread id (pid)
     int threadID; // 用來存放thread id (pid)
 
@@ -128,8 +257,31 @@ private:
                 // (If NULL, don't deallocate stack)
     ThreadStatus status; // ready, running or blocked
     char *name;
-    int burstTime;
-    int priority;
+    int burstTime;     // predicted length of the next CPU burst, in ticks
+    int burstStart;    // when we last got the CPU
+    int burstSoFar;    // CPU time used by the current burst before that
+    int numBursts;     // number of CPU bursts finished so far
+    int predictedTotal, actualTotal; // sums of predicted and actual bursts
+    int errorTotal;    // sum of |predicted - actual|
+    int priority;      // the one we're scheduled by: the best of our
+                       // own and those of threads waiting for our locks
+    int basePriority;  // our own, set with setPriority
+    Lock *heldLocks;   // locks we hold, linked through Lock::nextHeld
+    Lock *waitingFor;  // lock we're waiting to acquire, or NULL
+    int quantum;       // how long we may run before being preempted,
+                       // or 0 for the default for our priority
+    int quantumUsed;   // how much of it we've used so far
+    int wakeTime;      // when the alarm clock is to wake us up
+    int level;         // MLFQ level
+    ThreadStats *stats; // our scheduling history, owned by the
+                        // scheduler
+    int tickets;       // our share of the CPU, for Stride and Lottery
+    int lentTickets;   // tickets lent to us by threads waiting for
+                       // locks we hold
+    unsigned int pass; // virtual time at which we should next run,
+                       // under stride scheduling
+    unsigned int vruntime; // virtual runtime, see Scheduler::Charge
+    RealTimeTask *realTime; // our real-time parameters, if any
     void StackAllocate(VoidFunctionPtr func, void *arg);
     // Allocate a stack for thread.
     // Used internally by Fork()
@@ -149,9 +301,15 @@ public:
 #endif
 };
 
+// a queue of threads, linked through their queueLink
+typedef LinkedList<Thread, &Thread::queueLink> ThreadQueue;
+
 // external function, dummy routine whose sole job is to call Thread::Print
 extern void ThreadPrint(Thread *thread);
 
+// time creating and finishing threads, with and without the stack pool
+extern void ForkBenchmark(int numThreads);
+
 // Magical machine-dependent routines, defined in switch.s
 
 extern "C"
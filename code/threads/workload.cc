@@ -0,0 +1,306 @@
+// workload.cc
+//	Routines to generate synthetic workloads, and to run them under
+//	each of the CPU schedulers in turn.
+//
+//	The benchmark builds a workload from a seed, then for each
+//	scheduler, swaps in a fresh scheduler of that type, runs the
+//	workload to completion, and prints how it did:
+//
+//	  - throughput: threads finished per 100000 ticks;
+//	  - mean and 99th percentile response time (arrival to first run);
+//	  - fairness: Jain's index of the threads' slowdowns (turnaround
+//	    over the time the thread would have taken on an idle machine),
+//	    in percent; 100 means every thread was slowed down equally;
+//	  - the number of context switches.
+//
+//	Since the same seed gives the same workload, and the random
+//	number generator is reseeded for each run, the results can be
+//	compared from one version of a scheduler to the next.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "workload.h"
+#include "synch.h"
+#include "main.h"
+#include "math.h"
+#include "iomanip"
+
+const int NumWorkThreads = 50;		// threads in each benchmark workload
+const int NumPriorityClasses = 8;	// priorities are drawn from 0..7
+
+//----------------------------------------------------------------------
+// Uniform
+// 	Return a pseudo-random number strictly between 0 and 1.
+//----------------------------------------------------------------------
+
+static double
+Uniform()
+{
+    return (RandomNumber() % 1000000 + 1) / 1000001.0;
+}
+
+//----------------------------------------------------------------------
+// Workload::Draw
+// 	Return a random burst length, at least one tick, from the given
+//	distribution with the given mean.
+//
+//	Bimodal bursts are short (a mean of half the mean) 80% of the
+//	time and long (three times the mean) the rest of the time.
+//	Heavy-tailed bursts are Pareto with shape 1.5, capped at 20
+//	times the mean so that one thread can't make a run take forever.
+//----------------------------------------------------------------------
+
+int
+Workload::Draw(BurstDistribution dist, int mean)
+{
+    double length;
+
+    switch (dist)
+    {
+    case Exponential:
+        length = -mean * log(Uniform());
+        break;
+    case Bimodal:
+        if (RandomNumber() % 100 < 80)
+        {
+            length = -(mean / 2.0) * log(Uniform());
+        }
+        else
+        {
+            length = -(mean * 3.0) * log(Uniform());
+        }
+        break;
+    case HeavyTailed:
+        length = (mean / 3.0) / pow(Uniform(), 1 / 1.5);
+        if (length > 20.0 * mean)
+        {
+            length = 20.0 * mean;
+        }
+        break;
+    }
+    return (length < 1) ? 1 : (int)length;
+}
+
+//----------------------------------------------------------------------
+// Workload::Workload
+// 	Generate a workload.  Threads arrive with exponentially
+//	distributed gaps between them; each has from 1 to MaxWorkBursts
+//	CPU bursts, with an I/O between each pair, drawn from "dist".
+//
+//	"seed" picks the workload; the same seed always gives the same one
+//	"numThreads" is the number of threads in it
+//	"dist" is the distribution of the CPU and I/O burst lengths
+//----------------------------------------------------------------------
+
+Workload::Workload(unsigned int s, int n, BurstDistribution dist)
+{
+    int arrival = 0;
+
+    seed = s;
+    numThreads = n;
+    work = new WorkThread[numThreads];
+    stats = new ThreadStats *[numThreads];
+    start = end = numSwitches = 0;
+
+    RandomInit(seed);
+    for (int i = 0; i < numThreads; i++)
+    {
+        WorkThread *w = &work[i];
+
+        w->arrival = arrival;
+        arrival += Draw(Exponential, MeanInterarrival);
+        w->priority = RandomNumber() % NumPriorityClasses;
+        w->tickets = (1 + RandomNumber() % 3) * DefaultTickets;
+        w->numBursts = 1 + RandomNumber() % MaxWorkBursts;
+        for (int j = 0; j < w->numBursts; j++)
+        {
+            w->cpu[j] = Draw(dist, MeanCpuBurst);
+            w->io[j] = (j < w->numBursts - 1) ? Draw(dist, MeanIOBurst) : 0;
+        }
+        stats[i] = NULL;
+    }
+}
+
+Workload::~Workload()
+{
+    delete[] work;
+    delete[] stats;
+}
+
+//----------------------------------------------------------------------
+// WorkThreadBody
+// 	What a workload thread does: spin for each CPU burst, sleep for
+//	each I/O, then tell Workload::Run that we're done.
+//
+//	Interrupts are turned off before the last V, and we finish
+//	straight away, so that we can't be preempted in between: the
+//	main thread must not see us done until our finish time is set
+//	and we are off the ready list of the scheduler it is about to
+//	delete.
+//----------------------------------------------------------------------
+
+static Semaphore *workDone;	// V'ed by each thread when it finishes
+
+static void
+WorkThreadBody(WorkThread *w)
+{
+    for (int j = 0; j < w->numBursts; j++)
+    {
+        for (int used = 0; used < w->cpu[j]; used += SystemTick)
+        {
+            kernel->interrupt->OneTick();
+        }
+        kernel->alarm->SleepFor(w->io[j]);
+    }
+    (void)kernel->interrupt->SetLevel(IntOff);
+    workDone->V();
+    kernel->currentThread->Finish();
+}
+
+//----------------------------------------------------------------------
+// Workload::Run
+// 	Run the workload under the current scheduler: create each thread
+//	when it arrives, then wait for all of them to finish.
+//----------------------------------------------------------------------
+
+void
+Workload::Run()
+{
+    static char names[NumWorkThreads][16]; // threads keep their names
+
+    ASSERT(numThreads <= NumWorkThreads);
+    RandomInit(seed); // so lotteries come out the same every time
+    workDone = new Semaphore("workload", 0);
+    start = kernel->stats->totalTicks;
+    numSwitches = -kernel->scheduler->getNumSwitches();
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        Thread *t;
+
+        kernel->alarm->WaitUntil(start + work[i].arrival);
+        sprintf(names[i], "work%d", i);
+        t = new Thread(names[i]);
+        t->setPriority(work[i].priority);
+        t->setTickets(work[i].tickets);
+        t->setBurstTime(MeanCpuBurst);
+        stats[i] = t->getStats();
+        t->Fork((VoidFunctionPtr)WorkThreadBody, (void *)&work[i]);
+    }
+    for (int i = 0; i < numThreads; i++)
+    {
+        workDone->P();
+    }
+    delete workDone;
+
+    end = kernel->stats->totalTicks;
+    numSwitches += kernel->scheduler->getNumSwitches();
+}
+
+//----------------------------------------------------------------------
+// Workload::PrintHeader, Workload::PrintResult
+// 	Print the comparison table, a row for each run.  PrintResult must
+//	be called before the scheduler of the run goes away, since it
+//	keeps the threads' histories.
+//----------------------------------------------------------------------
+
+void
+Workload::PrintHeader()
+{
+    cout << setw(10) << "scheduler" << setw(12) << "throughput"
+         << setw(12) << "resp mean" << setw(12) << "resp p99"
+         << setw(10) << "fairness" << setw(10) << "switches" << "\n";
+}
+
+static int
+CompareTimes(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+void
+Workload::PrintResult(const char *label)
+{
+    int *response = new int[numThreads];
+    int responseTotal = 0;
+    double sum = 0, sumSquares = 0;
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        int demand = 0;
+        double slowdown;
+
+        ASSERT(stats[i] != NULL && stats[i]->finishTime >= 0);
+        response[i] = stats[i]->ResponseTime();
+        responseTotal += response[i];
+        for (int j = 0; j < work[i].numBursts; j++)
+        {
+            demand += work[i].cpu[j] + work[i].io[j];
+        }
+        slowdown = (double)stats[i]->TurnaroundTime() / demand;
+        sum += slowdown;
+        sumSquares += slowdown * slowdown;
+    }
+    qsort(response, numThreads, sizeof(int), CompareTimes);
+
+    cout << setw(10) << label
+         << setw(12) << (int)(numThreads * 100000.0 / (end - start))
+         << setw(12) << responseTotal / numThreads
+         << setw(12) << response[(99 * numThreads + 99) / 100 - 1]
+         << setw(10) << (int)(100 * sum * sum / (numThreads * sumSquares))
+         << setw(10) << numSwitches << "\n";
+    delete[] response;
+}
+
+//----------------------------------------------------------------------
+// SchedulerBenchmark
+// 	Generate a workload with each burst distribution from "seed", and
+//	run it under each of the schedulers, printing a comparison table
+//	for each workload.
+//
+//	Each run gets a fresh scheduler, so that nothing carries over
+//	from one run to the next.  Nothing else may be running.
+//----------------------------------------------------------------------
+
+void
+SchedulerBenchmark(unsigned int seed)
+{
+    const int numTypes = 10;
+    SchedulerType types[numTypes] = {RR, FIFO, Priority, SJF, SRTF,
+                                     MLFQ, Stride, Lottery, CFS, EDF};
+    const char *typeNames[numTypes] = {"RR", "FCFS", "PRIORITY", "SJF", "SRTF",
+                                       "MLFQ", "STRIDE", "LOTTERY", "CFS", "EDF"};
+    const int numDists = 3;
+    BurstDistribution dists[numDists] = {Exponential, Bimodal, HeavyTailed};
+    const char *distNames[numDists] = {"exponential", "bimodal", "heavy-tailed"};
+
+    for (int d = 0; d < numDists; d++)
+    {
+        Workload *workload = new Workload(seed, NumWorkThreads, dists[d]);
+
+        cout << "\nWorkload: " << NumWorkThreads << " threads, " << distNames[d]
+             << " bursts, seed " << seed << "\n";
+        Workload::PrintHeader();
+        for (int i = 0; i < numTypes; i++)
+        {
+            Scheduler *saved = kernel->scheduler;
+            IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+            kernel->scheduler = new Scheduler(types[i]);
+            (void)kernel->interrupt->SetLevel(oldLevel);
+
+            workload->Run();
+            workload->PrintResult(typeNames[i]);
+
+            oldLevel = kernel->interrupt->SetLevel(IntOff);
+            kernel->alarm->StopQuantum();
+            delete kernel->scheduler;
+            kernel->scheduler = saved;
+            (void)kernel->interrupt->SetLevel(oldLevel);
+        }
+        delete workload;
+    }
+}
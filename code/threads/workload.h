@@ -0,0 +1,81 @@
+// workload.h
+//	Data structures for generating synthetic workloads, to compare
+//	the CPU schedulers against each other.
+//
+//	A workload is a set of threads that arrive over time, each
+//	alternating between CPU bursts (spinning) and I/O (sleeping on
+//	the alarm clock).  The burst lengths, arrival times, priorities
+//	and tickets are all drawn from a pseudo-random number generator,
+//	so the same seed always gives the same workload.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "copyright.h"
+#include "thread.h"
+#include "scheduler.h"
+
+// Shape of the distribution that CPU and I/O burst lengths are drawn
+// from.  All three have the same mean.
+enum BurstDistribution {
+    Exponential,	// memoryless
+    Bimodal,		// mostly short bursts, some very long ones
+    HeavyTailed		// Pareto: a few bursts are enormous
+};
+
+const int MaxWorkBursts = 8;		// most CPU bursts a thread has
+const int MeanCpuBurst = 200;		// mean length of a CPU burst, in ticks
+const int MeanIOBurst = 500;		// mean length of an I/O, in ticks
+const int MeanInterarrival = 100;	// mean time between arrivals
+
+// What one thread of a workload does.  Thread i arrives at arrival[i],
+// then alternates cpu[0], io[0], cpu[1], io[1], ..., cpu[numBursts-1].
+
+class WorkThread {
+  public:
+    int arrival;		// when it is created, relative to the
+				// start of the run
+    int priority;		// for the Priority scheduler
+    int tickets;		// for the proportional-share schedulers
+    int numBursts;
+    int cpu[MaxWorkBursts];	// lengths of its CPU bursts
+    int io[MaxWorkBursts];	// and of the I/O after each of them
+};
+
+// The following class defines a synthetic workload, and measures how
+// well the running scheduler did on it.
+
+class Workload {
+  public:
+    Workload(unsigned int seed, int numThreads, BurstDistribution dist);
+				// generate a workload
+    ~Workload();
+
+    void Run();			// run it to completion under the
+				// current scheduler
+    void PrintResult(const char *label);
+				// print one row of the comparison table
+    static void PrintHeader();	// print the table's column headings
+
+  private:
+    unsigned int seed;		// for the schedulers that draw lots
+    int numThreads;
+    WorkThread *work;		// what each thread does
+    ThreadStats **stats;	// each thread's history, from the
+				// last run
+    int start, end;		// when the last run started and ended
+    int numSwitches;		// context switches during the last run
+
+    int Draw(BurstDistribution dist, int mean);
+				// random burst length
+};
+
+extern void SchedulerBenchmark(unsigned int seed);
+				// run the same workloads under every
+				// scheduler, and compare them
+
+#endif // WORKLOAD_H
@@ -29,6 +29,23 @@
 
 bool AddrSpace::usedPhyPage[NumPhysPages] = {0};
 TranslationEntry *AddrSpace::usedPhyPageEntry[NumPhysPages] = {nullptr};
+AddrSpace *AddrSpace::usedPhyPageSpace[NumPhysPages] = {nullptr};
+int AddrSpace::usedPhyPagePins[NumPhysPages] = {0};
+List<SharedPage *> *AddrSpace::usedPhyPageSharers[NumPhysPages] = {nullptr};
+
+bool AddrSpace::loadControl = FALSE;
+List<AddrSpace *> *AddrSpace::spaces = new List<AddrSpace *>;
+
+int AddrSpace::clusterPages = DefaultClusterPages;
+BitMap *AddrSpace::swapMap = new BitMap(NumSectors);
+
+bool AddrSpace::pageMerging = FALSE;
+unsigned int AddrSpace::frameChecksum[NumPhysPages] = {0};
+int AddrSpace::scanCursor = 0;
+int AddrSpace::numMerges = 0;
+int AddrSpace::numCowBreaks = 0;
+int AddrSpace::framesSaved = 0;
+int AddrSpace::maxFramesSaved = 0;
 
 static void
 SwapHeader(NoffHeader *noffH)
@@ -68,6 +85,20 @@ AddrSpace::AddrSpace()
         pageTable[i].readOnly = FALSE;
     }
 
+    name = "";
+    numResident = 0;
+    frameQuota = MinFrameQuota;
+    workingSetSize = 0;
+    lastReference = NULL;
+    numFaults = intervalFaults = intervalStart = 0;
+    virtualTicks = runStart = 0;
+    running = FALSE;
+    suspended = FALSE;
+    suspendedThreads = new List<Thread *>;
+    swapClusters = NULL;
+    for (int i = 0; i < MaxOpenFiles; i++)
+        openFiles[i] = NULL;
+
     // zero out the entire address space
     //    bzero(kernel->machine->mainMemory, MemorySize);
 }
@@ -79,9 +110,40 @@ AddrSpace::AddrSpace()
 
 AddrSpace::~AddrSpace()
 {
-    for (int i = 0; i < numPages; i++)
-        AddrSpace::usedPhyPage[pageTable[i].physicalPage] = false;
-    delete pageTable;
+    DEBUG(dbgPaging, "Address space " << name << " exiting: " << numFaults
+                     << " page faults, working set " << workingSetSize);
+
+    // leave the merged pages first; this may hand a merged page over
+    // to one of our own pages, which is then released below
+    for (unsigned int i = 0; i < numPages; i++)
+        if (IsShared(i))
+            Unshare(pageTable[i].physicalPage, this, i);
+
+    // only release the frames we still own; pages that were swapped
+    // out may name a frame that now belongs to somebody else
+    for (unsigned int frame = 0; frame < NumPhysPages; frame++)
+        if (AddrSpace::usedPhyPageSpace[frame] == this)
+            AddrSpace::ReleaseFrame(frame);
+    if (spaces->IsInList(this))
+        spaces->Remove(this);
+    for (int i = 0; i < MaxOpenFiles; i++)
+        delete openFiles[i];
+#ifdef FILESYS
+    if (kernel->swapCache != NULL)
+        for (unsigned int i = 0; i < numPages; i++)
+            if (pageTable[i].diskPage != (unsigned int)-1)
+                kernel->swapCache->Invalidate(pageTable[i].diskPage);
+#endif
+    if (swapClusters != NULL)
+        for (unsigned int c = 0; c < divRoundUp(numPages, clusterPages); c++)
+            if (swapClusters[c] >= 0)
+                for (int i = 0; i < clusterPages; i++)
+                    swapMap->Clear(swapClusters[c] + i);
+    delete [] swapClusters;
+    ASSERT(suspendedThreads->IsEmpty());
+    delete suspendedThreads;
+    delete [] lastReference;
+    delete [] pageTable;
 }
 
 //----------------------------------------------------------------------
@@ -152,6 +214,14 @@ bool AddrSpace::Load(char *fileName)
 
     DEBUG(dbgAddr, "Initializing address space. # of pages = " << numPages << ", " << size << " bytes.");
 
+    name = fileName;
+    lastReference = new int[numPages];
+    for (unsigned int i = 0; i < numPages; i++)
+        lastReference[i] = -WorkingSetWindow; // never referenced
+    swapClusters = new int[divRoundUp(numPages, clusterPages)];
+    for (unsigned int c = 0; c < divRoundUp(numPages, clusterPages); c++)
+        swapClusters[c] = -1;
+
     DEBUG(dbgAddr, "Loading program into memory...");
     // 為暫存緩衝區分配記憶體，用於儲存代碼和數據段
     char *tempBuffer = new char[noffH.code.size + noffH.initData.size + noffH.uninitData.size];
@@ -192,8 +262,7 @@ bool AddrSpace::Load(char *fileName)
             // 若找到可用的物理頁框，將資料從暫存緩衝區加載到主記憶體
             memcpy(&(kernel->machine->mainMemory[filePageIndex * PageSize]), tempBuffer + offset, PageSize);
 
-            AddrSpace::usedPhyPage[filePageIndex] = true;                  // 標記該頁框為已使用
-            AddrSpace::usedPhyPageEntry[filePageIndex] = &pageTable[page]; // 記錄對應的頁表項
+            AddrSpace::AssignFrame(filePageIndex, this, &pageTable[page]); // 標記該頁框為已使用，並記錄對應的頁表項
             pageTable[page].physicalPage = filePageIndex;                  // 設定頁表的物理頁號
             pageTable[page].valid = true;                                 // 標記頁表的有效位
             pageTable[page].diskPage = -1;                                // 表示該頁於磁碟的位置未定
@@ -202,7 +271,7 @@ bool AddrSpace::Load(char *fileName)
         else
         {
             // 若無可用的物理頁框，將頁面寫入交換區（swap disk）
-            int diskSector = kernel->synchDisk->numUsedSectors++;
+            int diskSector = SwapSector(page);
             
             TranslationEntry* tmp = pageTable;
             DEBUG(dbgAddr, "Before WriteSector: pageTable = " << pageTable);
@@ -229,6 +298,12 @@ bool AddrSpace::Load(char *fileName)
     // 釋放暫存緩衝區的記憶體
     delete [] tempBuffer;
 
+    // start with the frames we were able to get, and let the
+    // page-fault-frequency controller adjust from there
+    if (numResident > frameQuota)
+        frameQuota = numResident;
+    spaces->Append(this);
+
     // 關閉檔案以釋放資源
     delete executable;
 
@@ -304,6 +379,12 @@ void AddrSpace::InitRegisters()
 
 void AddrSpace::SaveState()
 {
+    if (running)
+    {
+        virtualTicks += kernel->stats->userTicks - runStart;
+        running = FALSE;
+    }
+
     // 可以全都不做?
     if (kernel->machine->pageTable == nullptr) {
         kernel->machine->pageTable = pageTable;
@@ -327,4 +408,626 @@ void AddrSpace::RestoreState()
 {
     kernel->machine->pageTable = pageTable;
     kernel->machine->pageTableSize = numPages;
+
+    runStart = kernel->stats->userTicks;
+    running = TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::AssignFrame
+// 	Record that physical page "frame" now holds the virtual page
+//	described by "entry", belonging to address space "space".
+//----------------------------------------------------------------------
+
+void AddrSpace::AssignFrame(int frame, AddrSpace *space, TranslationEntry *entry)
+{
+    ASSERT(usedPhyPageSpace[frame] == NULL);
+    usedPhyPage[frame] = TRUE;
+    usedPhyPageEntry[frame] = entry;
+    usedPhyPageSpace[frame] = space;
+    space->numResident++;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::ReleaseFrame
+// 	Forget about the contents of physical page "frame", either because
+//	it has been swapped out or because its owner has exited.  The
+//	caller is responsible for invalidating the page table entry.
+//----------------------------------------------------------------------
+
+void AddrSpace::ReleaseFrame(int frame)
+{
+    AddrSpace *space = usedPhyPageSpace[frame];
+
+    if (space != NULL)
+        space->numResident--;
+    usedPhyPage[frame] = FALSE;
+    usedPhyPageEntry[frame] = NULL;
+    usedPhyPageSpace[frame] = NULL;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::VirtualTime
+// 	Return the number of user instructions this process has executed,
+//	which is the clock the working-set model is defined against.
+//----------------------------------------------------------------------
+
+int AddrSpace::VirtualTime()
+{
+    if (running)
+        return virtualTicks + kernel->stats->userTicks - runStart;
+    return virtualTicks;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PageFaulted
+// 	Account for a page fault taken by the current thread.  If load
+//	control has suspended this process, the thread sleeps here until
+//	there is room for its working set again.
+//----------------------------------------------------------------------
+
+void AddrSpace::PageFaulted()
+{
+    numFaults++;
+    intervalFaults++;
+
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    while (suspended)
+    {
+        DEBUG(dbgPaging, "Address space " << name << " blocked while suspended");
+        suspendedThreads->Append(kernel->currentThread);
+        kernel->currentThread->Sleep(FALSE);
+    }
+    (void)kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SampleWorkingSet
+// 	Fold the hardware use bits into the per-page reference times, and
+//	re-estimate the working set: the pages referenced during the last
+//	WorkingSetWindow ticks of virtual time.
+//----------------------------------------------------------------------
+
+void AddrSpace::SampleWorkingSet()
+{
+    int now = VirtualTime();
+
+    // only resident pages can have their use bit set, merged ones included
+    for (unsigned int vpn = 0; vpn < numPages; vpn++)
+    {
+        if (pageTable[vpn].use)
+        {
+            lastReference[vpn] = now;
+            pageTable[vpn].use = FALSE;
+        }
+    }
+
+    workingSetSize = 0;
+    for (unsigned int vpn = 0; vpn < numPages; vpn++)
+        if (now - lastReference[vpn] < WorkingSetWindow)
+            workingSetSize++;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::AdjustQuota
+// 	Page-fault-frequency control: once per PffInterval of virtual time,
+//	grow the frame quota of a process that faults too often, and shrink
+//	(but not below its working set) that of a process that rarely faults.
+//----------------------------------------------------------------------
+
+void AddrSpace::AdjustQuota()
+{
+    int now = VirtualTime();
+
+    if (now - intervalStart < PffInterval)
+        return;
+
+    if (intervalFaults > PffHighFaults && frameQuota < (int)NumPhysPages)
+        frameQuota++;
+    else if (intervalFaults < PffLowFaults && frameQuota > workingSetSize &&
+             frameQuota > MinFrameQuota)
+        frameQuota--;
+
+    DEBUG(dbgPaging, "[" << kernel->stats->totalTicks << "] " << name
+                     << ": rss " << numResident << ", working set " << workingSetSize
+                     << ", quota " << frameQuota << ", faults " << intervalFaults
+                     << " per " << (now - intervalStart) << " ticks");
+
+    intervalFaults = 0;
+    intervalStart = now;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Suspend
+// 	Swap out a whole process.  We can't do disk I/O from inside the
+//	timer interrupt, so instead we unmap every resident page and drop
+//	the quota to zero: the process blocks on its next reference, and
+//	its frames become the first victims of the page replacement.
+//	Pages that are still resident when it is resumed are simply
+//	mapped back in without any I/O.
+//
+//	Merged pages aren't owned by any one space, so they are found
+//	in our page table instead; they stay in memory for the other
+//	sharers, but we must not keep running on them.
+//----------------------------------------------------------------------
+
+void AddrSpace::Suspend()
+{
+    DEBUG(dbgPaging, "Suspending " << name << ", working set " << workingSetSize);
+
+    suspended = TRUE;
+    frameQuota = 0;
+    for (unsigned int frame = 0; frame < NumPhysPages; frame++)
+        if (usedPhyPageSpace[frame] == this)
+            usedPhyPageEntry[frame]->valid = FALSE;
+    for (unsigned int vpn = 0; vpn < numPages; vpn++)
+        if (IsShared(vpn))
+            pageTable[vpn].valid = FALSE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Resume
+// 	Let a suspended process run again, with its last working set as
+//	its frame quota.
+//----------------------------------------------------------------------
+
+void AddrSpace::Resume()
+{
+    DEBUG(dbgPaging, "Resuming " << name << ", working set " << workingSetSize);
+
+    suspended = FALSE;
+    frameQuota = workingSetSize > MinFrameQuota ? workingSetSize : MinFrameQuota;
+    while (!suspendedThreads->IsEmpty())
+        kernel->scheduler->ReadyToRun(suspendedThreads->RemoveFront());
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SampleWorkingSets
+// 	Called from the timer interrupt handler.  Update the working-set
+//	estimate of every address space, and if load control is enabled,
+//	run the PFF controller and suspend or resume whole processes so
+//	that the working sets of the running processes fit in memory.
+//
+//	Returns TRUE if a suspended process was made runnable.
+//----------------------------------------------------------------------
+
+bool AddrSpace::SampleWorkingSets()
+{
+    ListIterator<AddrSpace *> it(spaces);
+    AddrSpace *largest = NULL;
+    AddrSpace *firstSuspended = NULL;
+    int numActive = 0;
+    int totalWorkingSet = 0;
+
+    for (; !it.IsDone(); it.Next())
+    {
+        AddrSpace *space = it.Item();
+        space->SampleWorkingSet();
+        if (space->suspended)
+        {
+            if (firstSuspended == NULL)
+                firstSuspended = space;
+            continue;
+        }
+        space->AdjustQuota();
+        numActive++;
+        totalWorkingSet += space->workingSetSize > MinFrameQuota ? space->workingSetSize : MinFrameQuota;
+        if (largest == NULL || space->workingSetSize >= largest->workingSetSize)
+            largest = space;
+    }
+
+    if (!loadControl)
+        return FALSE;
+
+    if (totalWorkingSet > (int)NumPhysPages && numActive > 1)
+    {
+        largest->Suspend();
+    }
+    else if (firstSuspended != NULL &&
+             (numActive == 0 || totalWorkingSet + firstSuspended->workingSetSize <= (int)NumPhysPages))
+    {
+        firstSuspended->Resume();
+        return TRUE;
+    }
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SwapSector
+// 	Return the swap sector that holds page "vpn" while it is swapped
+//	out.  Sectors are allocated a cluster at a time: clusterPages
+//	virtually contiguous pages get clusterPages consecutive sectors,
+//	aligned so that the run never crosses a track boundary.
+//----------------------------------------------------------------------
+
+int AddrSpace::SwapSector(int vpn)
+{
+    int cluster = vpn / clusterPages;
+
+    if (swapClusters[cluster] < 0)
+    {
+        for (int base = 0; base < NumSectors; base += clusterPages)
+        {
+            int i = 0;
+            while (i < clusterPages && !swapMap->Test(base + i))
+                i++;
+            if (i == clusterPages)
+            {
+                for (i = 0; i < clusterPages; i++)
+                    swapMap->Mark(base + i);
+                swapClusters[cluster] = base;
+                break;
+            }
+        }
+        ASSERT(swapClusters[cluster] >= 0); // out of swap space
+        DEBUG(dbgPaging, name << ": pages " << cluster * clusterPages << ".."
+                         << (cluster + 1) * clusterPages - 1 << " swap to sectors "
+                         << swapClusters[cluster] << ".." << swapClusters[cluster] + clusterPages - 1);
+    }
+    return swapClusters[cluster] + vpn % clusterPages;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::IsResident
+// 	Return TRUE if page "vpn" occupies a physical page, even if it is
+//	not mapped at the moment (see Suspend) or is still being read in,
+//	or shares a merged physical page.
+//----------------------------------------------------------------------
+
+bool AddrSpace::IsResident(int vpn)
+{
+    unsigned int frame = pageTable[vpn].physicalPage;
+
+    return frame < NumPhysPages &&
+           (usedPhyPageEntry[frame] == &pageTable[vpn] || IsShared(vpn));
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Evictable, AddrSpace::SwappedOut
+// 	Can page "vpn" be swapped out along with a neighbour: is it
+//	resident, not merged, not recently referenced and not busy?  Can it be
+//	swapped in along with a neighbour: is its content on swap?
+//----------------------------------------------------------------------
+
+bool AddrSpace::Evictable(int vpn)
+{
+    return IsResident(vpn) && !IsShared(vpn) && !pageTable[vpn].use &&
+           usedPhyPagePins[pageTable[vpn].physicalPage] == 0;
+}
+
+bool AddrSpace::SwappedOut(int vpn)
+{
+    return !IsResident(vpn) && pageTable[vpn].diskPage != (unsigned int)-1;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::EvictionCluster
+// 	Page "vpn" has been chosen to be swapped out.  Find the longest run
+//	of pages around it, within its swap cluster, that can go out with
+//	it in the same disk request: resident pages that haven't been
+//	referenced since the last timer interrupt and aren't busy.
+//
+//	Returns the length of the run, and its first page in "first".
+//----------------------------------------------------------------------
+
+int AddrSpace::EvictionCluster(int vpn, int *first)
+{
+    int base = vpn - vpn % clusterPages;
+    int end = base + clusterPages;
+    int lo = vpn, hi = vpn;
+
+    if (end > (int)numPages)
+        end = numPages;
+
+    while (lo > base && Evictable(lo - 1))
+        lo--;
+    while (hi + 1 < end && Evictable(hi + 1))
+        hi++;
+
+    *first = lo;
+    return hi - lo + 1;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PrefetchCluster
+// 	Page "vpn" is about to be swapped in.  Find the longest run of
+//	pages around it, within its swap cluster, that are also swapped
+//	out and can be read in with it, as long as there are free
+//	physical pages to put them in (not counting the one reserved for
+//	"vpn" itself).  Pages after "vpn" are preferred to pages before.
+//
+//	Returns the length of the run, and its first page in "first".
+//----------------------------------------------------------------------
+
+int AddrSpace::PrefetchCluster(int vpn, int *first)
+{
+    int base = vpn - vpn % clusterPages;
+    int end = base + clusterPages;
+    int lo = vpn, hi = vpn;
+    int freeFrames = -1;
+
+    if (end > (int)numPages)
+        end = numPages;
+    for (unsigned int frame = 0; frame < NumPhysPages; frame++)
+        if (!usedPhyPage[frame])
+            freeFrames++;
+
+    while (freeFrames > 0 && hi + 1 < end && SwappedOut(hi + 1))
+    {
+        hi++;
+        freeFrames--;
+    }
+    while (freeFrames > 0 && lo > base && SwappedOut(lo - 1))
+    {
+        lo--;
+        freeFrames--;
+    }
+
+    *first = lo;
+    return hi - lo + 1;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Mergeable
+// 	Can physical page "frame" be merged with an identical one?  It must
+//	hold a single mapped page that isn't being read in.
+//----------------------------------------------------------------------
+
+bool AddrSpace::Mergeable(int frame)
+{
+    return usedPhyPageEntry[frame] != NULL && usedPhyPageEntry[frame]->valid &&
+           usedPhyPagePins[frame] == 0;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Checksum
+// 	Hash the contents of physical page "frame" (one-at-a-time hash).
+//	Zero is reserved to mean "not checksummed".
+//----------------------------------------------------------------------
+
+unsigned int AddrSpace::Checksum(int frame)
+{
+    unsigned char *p = (unsigned char *)&kernel->machine->mainMemory[frame * PageSize];
+    unsigned int hash = 0;
+
+    for (unsigned int i = 0; i < PageSize; i++)
+    {
+        hash += p[i];
+        hash += hash << 10;
+        hash ^= hash >> 6;
+    }
+    hash += hash << 3;
+    hash ^= hash >> 11;
+    hash += hash << 15;
+    return hash == 0 ? 1 : hash;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::ScanForDuplicates
+// 	Called from the timer interrupt handler.  Checksum the next few
+//	physical pages, and merge any page whose contents haven't changed
+//	since the last scan with an identical page.  Pages that keep
+//	changing are not worth merging, since they would just be copied
+//	again on the next write.
+//----------------------------------------------------------------------
+
+void AddrSpace::ScanForDuplicates()
+{
+    if (!pageMerging)
+        return;
+
+    for (int n = 0; n < MergeScanFrames; n++)
+    {
+        int frame = scanCursor;
+        scanCursor = (scanCursor + 1) % NumPhysPages;
+
+        if (!Mergeable(frame))
+        {
+            if (usedPhyPageSharers[frame] == NULL)
+                frameChecksum[frame] = 0;
+            continue;
+        }
+        unsigned int sum = Checksum(frame);
+        if (sum != frameChecksum[frame])
+        {
+            frameChecksum[frame] = sum; // changed since the last scan
+            continue;
+        }
+
+        for (unsigned int other = 0; other < NumPhysPages; other++)
+        {
+            if (other != (unsigned int)frame && frameChecksum[other] == sum &&
+                (usedPhyPageSharers[other] != NULL || Mergeable(other)) &&
+                memcmp(&kernel->machine->mainMemory[frame * PageSize],
+                       &kernel->machine->mainMemory[other * PageSize], PageSize) == 0)
+            {
+                Merge(frame, other);
+                break;
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Merge
+// 	Map the page in physical page "frame" onto the identical physical
+//	page "into", read-only, and free "frame".
+//----------------------------------------------------------------------
+
+void AddrSpace::Merge(int frame, int into)
+{
+    AddrSpace *space = usedPhyPageSpace[frame];
+    TranslationEntry *entry = usedPhyPageEntry[frame];
+
+    if (usedPhyPageSharers[into] == NULL)
+    {
+        // "into" becomes a merged page; its owner is now just a sharer
+        AddrSpace *owner = usedPhyPageSpace[into];
+        TranslationEntry *ownerEntry = usedPhyPageEntry[into];
+
+        usedPhyPageSharers[into] = new List<SharedPage *>;
+        usedPhyPageSharers[into]->Append(new SharedPage(owner, ownerEntry->virtualPage));
+        ownerEntry->readOnly = TRUE;
+        owner->numResident--;
+        usedPhyPageEntry[into] = NULL;
+        usedPhyPageSpace[into] = NULL;
+    }
+    usedPhyPageSharers[into]->Append(new SharedPage(space, entry->virtualPage));
+    entry->readOnly = TRUE;
+    entry->physicalPage = into;
+    ReleaseFrame(frame);
+    frameChecksum[frame] = 0;
+
+    numMerges++;
+    framesSaved++;
+    if (framesSaved > maxFramesSaved)
+        maxFramesSaved = framesSaved;
+    DEBUG(dbgPaging, "Merged page " << entry->virtualPage << " of " << space->name
+                     << " into physical page " << into << ", "
+                     << usedPhyPageSharers[into]->NumInList() << " sharers");
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Unshare
+// 	Remove page "vpn" of "space" from the sharers of merged physical
+//	page "frame".  If only one sharer is left, it gets the physical
+//	page to itself again.
+//----------------------------------------------------------------------
+
+void AddrSpace::Unshare(int frame, AddrSpace *space, int vpn)
+{
+    List<SharedPage *> *sharers = usedPhyPageSharers[frame];
+    ListIterator<SharedPage *> it(sharers);
+    SharedPage *found = NULL;
+
+    for (; !it.IsDone() && found == NULL; it.Next())
+        if (it.Item()->space == space && it.Item()->vpn == vpn)
+            found = it.Item();
+    ASSERT(found != NULL);
+    sharers->Remove(found);
+    delete found;
+    space->pageTable[vpn].readOnly = FALSE;
+    framesSaved--;
+
+    if (sharers->NumInList() == 1)
+        MakePrivate(frame);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::MakePrivate
+// 	Merged physical page "frame" has just one sharer left; make it an
+//	ordinary, writable page of that sharer.
+//----------------------------------------------------------------------
+
+void AddrSpace::MakePrivate(int frame)
+{
+    List<SharedPage *> *sharers = usedPhyPageSharers[frame];
+    SharedPage *last;
+    TranslationEntry *entry;
+
+    ASSERT(sharers->NumInList() == 1);
+    last = sharers->RemoveFront();
+    entry = &last->space->pageTable[last->vpn];
+    entry->readOnly = FALSE;
+    usedPhyPageSharers[frame] = NULL;
+    AssignFrame(frame, last->space, entry);
+    delete last;
+    delete sharers;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::BreakSharing
+// 	Copy-on-write for merged page "vpn", which we have just tried to
+//	write to.  "copy" is a free physical page that the caller has
+//	already copied the contents into.
+//----------------------------------------------------------------------
+
+void AddrSpace::BreakSharing(int vpn, int copy)
+{
+    TranslationEntry *entry = &pageTable[vpn];
+    int frame = entry->physicalPage;
+
+    ASSERT(IsShared(vpn) && usedPhyPageSharers[frame] != NULL);
+    numCowBreaks++;
+    DEBUG(dbgPaging, "Copy-on-write of page " << vpn << " of " << name);
+
+    Unshare(frame, this, vpn);
+    entry->physicalPage = copy;
+    AssignFrame(copy, this, entry);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::TakeSharers
+// 	Merged physical page "frame" is being swapped out.  Unmap it from
+//	all of its sharers, free it, and return the sharers, so that the
+//	caller can write the contents to each of their swap sectors.
+//----------------------------------------------------------------------
+
+List<SharedPage *> *AddrSpace::TakeSharers(int frame)
+{
+    List<SharedPage *> *sharers = usedPhyPageSharers[frame];
+    ListIterator<SharedPage *> it(sharers);
+
+    for (; !it.IsDone(); it.Next())
+    {
+        TranslationEntry *entry = &it.Item()->space->pageTable[it.Item()->vpn];
+        entry->valid = FALSE;
+        entry->readOnly = FALSE;
+        entry->diskPage = it.Item()->space->SwapSector(it.Item()->vpn);
+    }
+    framesSaved -= sharers->NumInList() - 1;
+    usedPhyPageSharers[frame] = NULL;
+    frameChecksum[frame] = 0;
+    ReleaseFrame(frame);
+    return sharers;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PrintMergeStats
+// 	Print how many physical pages same-page merging saved.
+//----------------------------------------------------------------------
+
+void AddrSpace::PrintMergeStats()
+{
+    if (!pageMerging)
+        return;
+    cout << "Page merging: merges " << numMerges << ", copy-on-writes " << numCowBreaks
+         << ", frames saved " << framesSaved << " (peak " << maxFramesSaved << ")\n";
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::AddOpenFile, GetOpenFile, CloseOpenFile
+// 	Manage the process's table of open files.  OpenFileIds 0 and 1
+//	are the console (see syscall.h), and are never in the table.
+//----------------------------------------------------------------------
+
+int AddrSpace::AddOpenFile(OpenFile *file)
+{
+    for (int id = 2; id < MaxOpenFiles; id++)
+    {
+        if (openFiles[id] == NULL)
+        {
+            openFiles[id] = file;
+            return id;
+        }
+    }
+    return -1;
+}
+
+OpenFile *AddrSpace::GetOpenFile(int id)
+{
+    if (id < 2 || id >= MaxOpenFiles)
+        return NULL;
+    return openFiles[id];
+}
+
+bool AddrSpace::CloseOpenFile(int id)
+{
+    OpenFile *file = GetOpenFile(id);
+
+    if (file == NULL)
+        return FALSE;
+    delete file;
+    openFiles[id] = NULL;
+    return TRUE;
 }
@@ -15,10 +15,59 @@
 
 #include "copyright.h"
 #include "filesys.h"
+#include "list.h"
+#include "bitmap.h"
 #include <string.h>
 
 #define UserStackSize 1024 // increase this as necessary!
 
+// Working-set estimation and page-fault-frequency (PFF) load control.
+// All intervals are measured in the address space's own virtual time,
+// i.e. the user ticks its thread has executed, so that time spent
+// blocked on the swap disk does not dilute the fault rate.
+
+const int WorkingSetWindow = 1000; // a page referenced within this many
+                                   // ticks belongs to the working set
+const int PffInterval = 1000;      // re-evaluate frame quotas this often
+const int PffHighFaults = 10;      // faults per interval above which the
+                                   // frame quota grows
+const int PffLowFaults = 2;        // faults per interval below which the
+                                   // frame quota shrinks
+const int MinFrameQuota = 4;       // an instruction may touch 2 pages;
+                                   // leave some slack on top of that
+
+// Swap clustering.  Swap slots are handed out a cluster of virtually
+// contiguous pages at a time, as a run of sectors on one track, so
+// that neighbouring pages can be swapped out and back in with a single
+// disk request.
+
+const int DefaultClusterPages = 8; // must divide SectorsPerTrack
+
+// Same-page merging.  A scan run from the timer interrupt checksums a
+// few physical pages at a time, and maps virtual pages with identical
+// contents onto a single physical page, read-only.  A write to such a
+// page raises ReadOnlyException, and the writer gets a private copy
+// back (copy-on-write).  The page table entry's readOnly bit is set
+// exactly when the page is merged.
+
+const int MergeScanFrames = 4;     // physical pages checksummed per
+                                   // timer interrupt
+
+const int MaxOpenFiles = 16;       // per process, including the console
+
+class Thread;
+class AddrSpace;
+
+// One virtual page mapped onto a merged physical page.
+
+class SharedPage
+{
+public:
+    SharedPage(AddrSpace *s, int v) { space = s; vpn = v; }
+    AddrSpace *space;
+    int vpn;
+};
+
 class AddrSpace
 {
 public:
@@ -29,6 +78,34 @@ public:
     static bool usedPhyPage[NumPhysPages];
     // 紀錄主記憶體中的Page被誰使用了
     static TranslationEntry *usedPhyPageEntry[NumPhysPages]; // 這是全局的，用來記錄哪些physical page被誰使用了，用於之後把main memory的內容寫入disk
+    // 紀錄主記憶體中的Page屬於哪一個 address space
+    static AddrSpace *usedPhyPageSpace[NumPhysPages];
+
+    static void AssignFrame(int frame, AddrSpace *space, TranslationEntry *entry);
+                                // record that "frame" now holds "entry"
+    static void ReleaseFrame(int frame); // mark "frame" as free
+    // 紀錄主記憶體中的Page是否正在做 I/O (不能被換出)
+    static int usedPhyPagePins[NumPhysPages];
+    static void PinFrame(int frame) { usedPhyPagePins[frame]++; }
+    static void UnpinFrame(int frame) { usedPhyPagePins[frame]--; }
+    // 紀錄被合併的 Page 被哪些 virtual page 共用 (沒有合併則為 NULL)
+    static List<SharedPage *> *usedPhyPageSharers[NumPhysPages];
+
+    static bool loadControl;    // enforce PFF frame quotas and suspend
+                                // processes when memory is overcommitted
+    static bool SampleWorkingSets();
+                                // called on every timer interrupt;
+                                // returns TRUE if a suspended process
+                                // was made runnable again
+    static int clusterPages;    // pages per swap cluster (1 disables
+                                // clustering)
+
+    static bool pageMerging;    // merge identical physical pages
+    static void ScanForDuplicates();
+                                // called on every timer interrupt
+    static List<SharedPage *> *TakeSharers(int frame);
+                                // unmap a merged page, to swap it out
+    static void PrintMergeStats();
 
     void Execute(char *fileName); // Run the the program
                                   // stored in the file "executable"
@@ -42,8 +119,77 @@ public:
     TranslationEntry *pageTable; // Assume linear page table translation (array)
                                 // for now!
 
+    void PageFaulted();         // account for a page fault; blocks the
+                                // caller while the process is suspended
+    int VirtualTime();          // user ticks executed by this process
+
+    bool IsSuspended() { return suspended; }
+    bool OverQuota() { return numResident > frameQuota; }
+    bool UnderQuota() { return numResident < frameQuota; }
+
+    int SwapSector(int vpn);    // the swap slot of page "vpn"
+    bool IsResident(int vpn);   // is page "vpn" in a physical page?
+    int EvictionCluster(int vpn, int *first);
+                                // run of pages to swap out along
+                                // with page "vpn"; returns its length
+    int PrefetchCluster(int vpn, int *first);
+                                // run of pages to swap in along with
+                                // page "vpn"; returns its length
+    int AddOpenFile(OpenFile *file); // returns its OpenFileId, or -1
+    OpenFile *GetOpenFile(int id);   // NULL if "id" isn't an open file
+    bool CloseOpenFile(int id);
+
+    bool IsShared(int vpn) { return pageTable[vpn].readOnly; }
+                                // is page "vpn" merged with others?
+    void BreakSharing(int vpn, int copy);
+                                // copy-on-write: move page "vpn" to
+                                // its copy in physical page "copy"
+
 private:
+    const char *name;           // executable, for reports
+    int numResident;            // frames currently held
+    int frameQuota;             // frames the PFF controller allows us
+    int workingSetSize;         // last working-set estimate
+    int *lastReference;         // virtual time each page was last used
+    int numFaults;              // page faults since the program started
+    int intervalFaults;         // page faults in the current PFF interval
+    int intervalStart;          // virtual time the interval began
+
+    int virtualTicks;           // user ticks accumulated while switched out
+    int runStart;               // stats->userTicks when last switched in
+    bool running;               // is our thread on the CPU?
+
+    bool suspended;             // swapped out by load control
+    List<Thread *> *suspendedThreads; // threads waiting to be resumed
+
+    static List<AddrSpace *> *spaces; // all loaded address spaces
+
+    static unsigned int frameChecksum[NumPhysPages];
+                                // contents of each physical page when
+                                // the merge scan last saw it
+    static int scanCursor;      // next physical page to scan
+    static int numMerges, numCowBreaks;
+    static int framesSaved, maxFramesSaved;
+
+    static bool Mergeable(int frame);
+    static unsigned int Checksum(int frame);
+    static void Merge(int frame, int into);
+    static void Unshare(int frame, AddrSpace *space, int vpn);
+    static void MakePrivate(int frame);
+
+    OpenFile *openFiles[MaxOpenFiles]; // indexed by OpenFileId; 0 and 1
+                                // are the console
+
+    int *swapClusters;          // first swap sector of each cluster,
+                                // or -1 if not allocated yet
+    static BitMap *swapMap;     // swap sectors in use
 
+    void SampleWorkingSet();    // fold use bits into the working set
+    void AdjustQuota();         // page-fault-frequency controller
+    void Suspend();             // give up all frames until resumed
+    void Resume();              // make the process runnable again
+    bool Evictable(int vpn);    // can go out with a neighbour
+    bool SwappedOut(int vpn);   // can come in with a neighbour
 
 
     bool Load(char *fileName); // Load the program into memory
@@ -23,9 +23,134 @@
 
 #include "copyright.h"
 #include "main.h"
+#include "synchconsole.h"
 #include "syscall.h"
 #include "machine.h"
 
+// Longest file name a user program may pass us, including the null
+const int MaxUserString = 256;
+
+// The console is only opened once a user program uses it; an open
+// keyboard keeps polling, which would stop Nachos from ever halting.
+static SynchConsoleInput *consoleIn = NULL;
+static SynchConsoleOutput *consoleOut = NULL;
+
+//----------------------------------------------------------------------
+// SysCreate, SysOpen, SysRead, SysWrite, SysClose
+// 	The file system calls (see syscall.h).  User buffers and names are
+//	moved with Machine::CopyFromUser/CopyToUser/CopyStringFromUser,
+//	through a page-sized kernel buffer.  Each returns the value to
+//	put in r2, -1 on error.
+//----------------------------------------------------------------------
+
+static int
+SysCreate(int nameAddr)
+{
+	char name[MaxUserString];
+
+	if (kernel->machine->CopyStringFromUser(nameAddr, name, MaxUserString) < 0)
+		return -1;
+#ifdef FILESYS_STUB
+	return kernel->fileSystem->Create(name) ? 1 : -1;
+#else
+	return kernel->fileSystem->Create(name, 0) ? 1 : -1;
+#endif
+}
+
+static int
+SysOpen(int nameAddr)
+{
+	char name[MaxUserString];
+	OpenFile *file;
+	int id;
+
+	if (kernel->machine->CopyStringFromUser(nameAddr, name, MaxUserString) < 0)
+		return -1;
+	file = kernel->fileSystem->Open(name);
+	if (file == NULL)
+		return -1;
+	id = kernel->currentThread->space->AddOpenFile(file);
+	if (id < 0)
+		delete file;
+	return id;
+}
+
+static int
+SysRead(int bufferAddr, int size, int id)
+{
+	char buffer[PageSize];
+	OpenFile *file = NULL;
+	int done = 0;
+
+	if (id != ConsoleInput) {
+		file = kernel->currentThread->space->GetOpenFile(id);
+		if (file == NULL)
+			return -1;
+	} else if (consoleIn == NULL) {
+		consoleIn = new SynchConsoleInput(NULL);
+	}
+
+	while (done < size) {
+		int chunk = size - done < (int)PageSize ? size - done : PageSize;
+		int n = 0;
+
+		if (file != NULL) {
+			n = file->Read(buffer, chunk);
+		} else {
+			// wait for at least one character, then stop at a newline
+			while (n < chunk && (n == 0 || buffer[n - 1] != '\n'))
+				buffer[n++] = consoleIn->GetChar();
+		}
+		if (n > 0 && kernel->machine->CopyToUser(bufferAddr + done, buffer, n) < 0)
+			return -1;
+		done += n;
+		if (n < chunk || (file == NULL && buffer[n - 1] == '\n'))
+			break;
+	}
+	return done;
+}
+
+static int
+SysWrite(int bufferAddr, int size, int id)
+{
+	char buffer[PageSize];
+	OpenFile *file = NULL;
+	int done = 0;
+
+	if (id != ConsoleOutput) {
+		file = kernel->currentThread->space->GetOpenFile(id);
+		if (file == NULL)
+			return -1;
+	} else if (consoleOut == NULL) {
+		consoleOut = new SynchConsoleOutput(NULL);
+	}
+
+	while (done < size) {
+		int chunk = size - done < (int)PageSize ? size - done : PageSize;
+		int n = chunk;
+
+		if (kernel->machine->CopyFromUser(bufferAddr + done, buffer, chunk) < 0)
+			return -1;
+		if (file != NULL) {
+			n = file->Write(buffer, chunk);
+		} else {
+			for (int i = 0; i < chunk; i++)
+				consoleOut->PutChar(buffer[i]);
+		}
+		if (n > 0)
+			done += n;
+		if (n < chunk)
+			break;		// the file couldn't grow
+	}
+	return done;
+}
+
+static int
+SysClose(int id)
+{
+	return kernel->currentThread->space->CloseOpenFile(id) ? 1 : -1;
+}
+
 //----------------------------------------------------------------------
 // ExceptionHandler
 // 	Entry point into the Nachos kernel.  Called when a user program
@@ -54,7 +179,6 @@ void ExceptionHandler(ExceptionType which)
 	int type = kernel->machine->ReadRegister(2);
 	int val;
 	int virtAddr;
-	SwapType swapType;
 
 	switch (which)
 	{
@@ -69,6 +193,11 @@ void ExceptionHandler(ExceptionType which)
 			val = kernel->machine->ReadRegister(4);
 			cout << "Print integer:" << val << endl;
 			return;
+		case SC_Sleep:
+			val = kernel->machine->ReadRegister(4);
+			DEBUG(dbgAddr, "Sleep for " << val << " ticks\n");
+			kernel->alarm->SleepFor(val);
+			return;
 			/*		case SC_Exec:
 						DEBUG(dbgAddr, "Exec\n");
 						val = kernel->machine->ReadRegister(4);
@@ -78,6 +207,30 @@ void ExceptionHandler(ExceptionType which)
 						kernel->machine->WriteRegister(2, val);
 						return;
 					*/
+		case SC_Create:
+			val = SysCreate(kernel->machine->ReadRegister(4));
+			kernel->machine->WriteRegister(2, val);
+			return;
+		case SC_Open:
+			val = SysOpen(kernel->machine->ReadRegister(4));
+			kernel->machine->WriteRegister(2, val);
+			return;
+		case SC_Read:
+			val = SysRead(kernel->machine->ReadRegister(4),
+				      kernel->machine->ReadRegister(5),
+				      kernel->machine->ReadRegister(6));
+			kernel->machine->WriteRegister(2, val);
+			return;
+		case SC_Write:
+			val = SysWrite(kernel->machine->ReadRegister(4),
+				       kernel->machine->ReadRegister(5),
+				       kernel->machine->ReadRegister(6));
+			kernel->machine->WriteRegister(2, val);
+			return;
+		case SC_Close:
+			val = SysClose(kernel->machine->ReadRegister(4));
+			kernel->machine->WriteRegister(2, val);
+			return;
 		case SC_Exit:
 			DEBUG(dbgAddr, "Program exit\n");
 			val = kernel->machine->ReadRegister(4);
@@ -90,13 +243,15 @@ void ExceptionHandler(ExceptionType which)
 		}
 		break;
 	case PageFaultException:
-		kernel->stats->numPageFaults++;
-		cout << "page fault" << endl;
-		swapType = kernel->machine->swapType;
 		virtAddr = kernel->machine->ReadRegister(BadVAddrReg);
-		kernel->machine->swapPage(swapType, virtAddr);
+		kernel->machine->handlePageFault(virtAddr);
 		// kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) - 4);
 		return;
+	case ReadOnlyException:
+		// write to a merged page: copy-on-write, then retry the instruction
+		virtAddr = kernel->machine->ReadRegister(BadVAddrReg);
+		kernel->machine->copyOnWrite(virtAddr);
+		return;
 	default:
 		cerr << "Unexpected user mode exception" << which << "\n";
 		break;
@@ -0,0 +1,366 @@
+// swapcache.cc
+//	Routines to manage the compressed swap cache.
+//
+//	Pages are compressed with one of two cheap schemes:
+//
+//	  - a page which is a single 32-bit word repeated (very often
+//	    all zeroes) is stored as that word;
+//	  - anything else goes through a small LZ77 compressor.  The
+//	    output is a sequence of tokens: a control byte below 0x80
+//	    is followed by that many plus one literal bytes, and a control
+//	    byte of 0x80 or more is a copy of (control - 0x80 + MinMatch)
+//	    bytes from (next byte + 1) bytes back in the page.
+//
+//	A page that doesn't get smaller than PageSize is rejected, and
+//	goes straight to the disk.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "swapcache.h"
+#include "main.h"
+
+const int MinMatch = 3;			// shortest back reference worth coding
+const int MaxMatch = 0x7f + MinMatch;	// longest one a control byte can hold
+const int MaxLiterals = 0x80;		// longest literal run
+const int MaxDistance = 0x100;		// furthest back a reference can point
+
+// a compressed page never needs more room than this, since we give
+// up as soon as the output reaches PageSize
+const int MaxCompressed = PageSize + 2;
+
+// PageSize is unsigned; compare our (signed) lengths with this instead
+const int pageSize = PageSize;
+
+//----------------------------------------------------------------------
+// SwapCache::SwapCache
+// 	Initialize an empty swap cache.
+//
+//	"size" -- the number of bytes of compressed data the pool may hold
+//----------------------------------------------------------------------
+
+SwapCache::SwapCache(int size)
+{
+    ASSERT(PageSize == SectorSize);
+
+    poolSize = size;
+    poolUsed = 0;
+    for (int i = 0; i < NumSectors; i++) {
+	pages[i] = NULL;
+	lengths[i] = 0;
+    }
+    order = new List<int>;
+
+    numStores = numRejected = numSameFilled = numWriteBacks = 0;
+    numHits = numMisses = 0;
+    bytesIn = bytesOut = 0;
+}
+
+//----------------------------------------------------------------------
+// SwapCache::~SwapCache
+// 	De-allocate the pool.
+//----------------------------------------------------------------------
+
+SwapCache::~SwapCache()
+{
+    for (int i = 0; i < NumSectors; i++)
+	delete [] pages[i];
+    delete order;
+}
+
+//----------------------------------------------------------------------
+// SwapCache::Reserve
+// 	Make room in the pool for "count" pages that are about to be
+//	swapped out, by writing older pages back to the disk.
+//
+//	This must be done before the pages are unmapped: writing back
+//	blocks, and while we wait, a fault on a page that is in neither
+//	the pool nor the disk queue would read stale data from the disk.
+//	Nothing blocks between the last write-back and the Stores that
+//	follow, so no other thread can take the room in between.
+//
+//	Returns TRUE if we had to write back (and so blocked), in which
+//	case the caller must check whether its pages are still the ones
+//	to swap out.
+//----------------------------------------------------------------------
+
+bool
+SwapCache::Reserve(int count)
+{
+    int needed = count * (pageSize - 1);	// the most Store will keep
+    bool blocked = FALSE;
+
+    if (needed > poolSize)
+	needed = poolSize;
+    while (poolUsed + needed > poolSize && !order->IsEmpty()) {
+	WriteBack();
+	blocked = TRUE;
+    }
+    return blocked;
+}
+
+//----------------------------------------------------------------------
+// SwapCache::Store
+// 	Try to keep a page that is being swapped out in the pool.
+//	Never blocks: room must have been made with Reserve.
+//
+//	Returns FALSE if the page doesn't compress, or doesn't fit, in
+//	which case the caller must write it to the disk.
+//
+//	"sector" -- the swap sector that names the page
+//	"data" -- the contents of the page
+//----------------------------------------------------------------------
+
+bool
+SwapCache::Store(int sector, char *data)
+{
+    char buffer[MaxCompressed];
+    int length;
+
+    ASSERT(sector >= 0 && sector < NumSectors);
+    Remove(sector);			// any older copy is stale
+
+    length = Compress(data, buffer);
+    if (length >= pageSize || poolUsed + length > poolSize) {
+	DEBUG(dbgPaging, "Swap cache rejected sector " << sector);
+	numRejected++;
+	return FALSE;
+    }
+    if (buffer[0] == SameFilled)
+	numSameFilled++;
+
+    pages[sector] = new char[length];
+    bcopy(buffer, pages[sector], length);
+    lengths[sector] = length;
+    poolUsed += length;
+    order->Append(sector);
+
+    numStores++;
+    bytesIn += PageSize;
+    bytesOut += length;
+    DEBUG(dbgPaging, "Swap cache stored sector " << sector << " in "
+		     << length << " bytes");
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// SwapCache::Load
+// 	Swap a page back in from the pool, and drop it from the pool.
+//	Returns FALSE if the page isn't cached, in which case it is on
+//	the disk.
+//
+//	"sector" -- the swap sector that names the page
+//	"data" -- where to put the contents of the page
+//----------------------------------------------------------------------
+
+bool
+SwapCache::Load(int sector, char *data)
+{
+    ASSERT(sector >= 0 && sector < NumSectors);
+    if (pages[sector] == NULL) {
+	numMisses++;
+	return FALSE;
+    }
+    Decompress(pages[sector], lengths[sector], data);
+    Remove(sector);
+    numHits++;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// SwapCache::Invalidate
+// 	Forget about a page whose address space has gone away.
+//----------------------------------------------------------------------
+
+void
+SwapCache::Invalidate(int sector)
+{
+    ASSERT(sector >= 0 && sector < NumSectors);
+    Remove(sector);
+}
+
+//----------------------------------------------------------------------
+// SwapCache::Print
+// 	Print the compression ratio, the hit rate and the disk I/O that
+//	the pool avoided.
+//----------------------------------------------------------------------
+
+void
+SwapCache::Print()
+{
+    int numLoads = numHits + numMisses;
+    int writesSaved = numStores - numWriteBacks;
+    int ticksPerPage = kernel->machine->SwapTicksPerPage();
+
+    cout << "Swap cache: pool " << poolSize << " bytes, stores " << numStores
+	 << " (same-filled " << numSameFilled << "), rejected " << numRejected
+	 << ", write-backs " << numWriteBacks << "\n";
+    cout << "Swap cache: compression ratio ";
+    if (bytesOut > 0)
+	cout << (double)bytesIn / bytesOut;
+    else
+	cout << "n/a";
+    cout << " (" << bytesIn << " -> " << bytesOut << " bytes)";
+    cout << ", hits " << numHits << " of " << numLoads << " swap-ins";
+    if (numLoads > 0)
+	cout << " (" << 100 * numHits / numLoads << "%)";
+    cout << "\n";
+    cout << "Swap cache: disk I/O saved: reads " << numHits
+	 << ", writes " << writesSaved;
+    if (ticksPerPage > 0)
+	cout << ", about " << (numHits + writesSaved) * ticksPerPage
+	     << " ticks (" << ticksPerPage << " ticks per page of swap I/O)";
+    cout << "\n";
+}
+
+//----------------------------------------------------------------------
+// SwapCache::WriteBack
+// 	Make room in the pool by writing the oldest page in it to the
+//	disk.  The page is taken out of the pool before the write, and
+//	marked as being written, so a fault on it while we wait for the
+//	disk waits for the write to finish before reading it back.
+//----------------------------------------------------------------------
+
+void
+SwapCache::WriteBack()
+{
+    char data[PageSize];
+    int sector;
+    int start;
+
+    ASSERT(!order->IsEmpty());
+    sector = order->Front();
+    Decompress(pages[sector], lengths[sector], data);
+    Remove(sector);
+    kernel->machine->StartSwapWrite(sector, 1);
+    numWriteBacks++;
+
+    DEBUG(dbgPaging, "Swap cache full, writing back sector " << sector);
+    start = kernel->stats->totalTicks;
+    kernel->synchDisk->WriteSector(sector, data);
+    kernel->machine->EndSwapWrite(sector, 1);
+    kernel->machine->SwapIODone(TRUE, 1, kernel->stats->totalTicks - start);
+}
+
+//----------------------------------------------------------------------
+// SwapCache::Remove
+// 	Drop a page from the pool, if it's there.
+//----------------------------------------------------------------------
+
+void
+SwapCache::Remove(int sector)
+{
+    if (pages[sector] == NULL)
+	return;
+    order->Remove(sector);
+    poolUsed -= lengths[sector];
+    delete [] pages[sector];
+    pages[sector] = NULL;
+    lengths[sector] = 0;
+}
+
+//----------------------------------------------------------------------
+// SwapCache::Compress
+// 	Compress one page into "buffer", returning the compressed
+//	length.  A return value of PageSize or more means the page
+//	didn't compress, and "buffer" holds garbage.
+//----------------------------------------------------------------------
+
+int
+SwapCache::Compress(char *page, char *buffer)
+{
+    unsigned char *in = (unsigned char *) page;
+    unsigned char *out = (unsigned char *) buffer;
+    unsigned int *words = (unsigned int *) page;
+    int wordsPerPage = PageSize / sizeof(unsigned int);
+    int i, n, literals;
+
+    // same-filled page?
+    for (i = 1; i < wordsPerPage; i++)
+	if (words[i] != words[0])
+	    break;
+    if (i == wordsPerPage) {
+	out[0] = SameFilled;
+	bcopy(page, (char *) &out[1], sizeof(unsigned int));
+	return 1 + sizeof(unsigned int);
+    }
+
+    // greedy LZ77; the page is small enough to just search every
+    // earlier position for the longest match
+    out[0] = LzCompressed;
+    n = 1;
+    literals = 0;
+    for (i = 0; i < pageSize; ) {
+	int bestLength = 0, bestDistance = 0;
+	int start = (i > MaxDistance) ? i - MaxDistance : 0;
+
+	for (int j = start; j < i; j++) {
+	    int length = 0;
+	    while (i + length < pageSize && length < MaxMatch &&
+		   in[j + length] == in[i + length])
+		length++;
+	    if (length > bestLength) {
+		bestLength = length;
+		bestDistance = i - j;
+	    }
+	}
+
+	if (bestLength >= MinMatch) {
+	    if (n + 2 >= pageSize)
+		return pageSize;
+	    out[n++] = 0x80 + (bestLength - MinMatch);
+	    out[n++] = bestDistance - 1;
+	    literals = 0;
+	    i += bestLength;
+	} else {
+	    if (literals == 0 || literals == MaxLiterals) {
+		if (n + 2 >= pageSize)
+		    return pageSize;
+		literals = 0;
+		out[n++] = 0;			// start a new literal run
+	    } else if (n + 1 >= pageSize) {
+		return pageSize;
+	    }
+	    out[n - literals - 1] = literals;	// run length - 1
+	    out[n++] = in[i++];
+	    literals++;
+	}
+    }
+    return n;
+}
+
+//----------------------------------------------------------------------
+// SwapCache::Decompress
+// 	Undo Compress.
+//----------------------------------------------------------------------
+
+void
+SwapCache::Decompress(char *buffer, int length, char *page)
+{
+    unsigned char *in = (unsigned char *) buffer;
+    unsigned char *out = (unsigned char *) page;
+    int n = 1, i = 0;
+
+    if (in[0] == SameFilled) {
+	for (i = 0; i < pageSize; i += sizeof(unsigned int))
+	    bcopy((char *) &in[1], (char *) &out[i], sizeof(unsigned int));
+	return;
+    }
+
+    ASSERT(in[0] == LzCompressed);
+    while (n < length) {
+	int control = in[n++];
+	if (control < 0x80) {
+	    for (int k = 0; k <= control; k++)
+		out[i++] = in[n++];
+	} else {
+	    int count = control - 0x80 + MinMatch;
+	    int distance = in[n++] + 1;
+	    for (int k = 0; k < count; k++, i++)	// may overlap
+		out[i] = out[i - distance];
+	}
+    }
+    ASSERT(n == length && i == pageSize);
+}
@@ -0,0 +1,77 @@
+// swapcache.h
+//	Data structures for a compressed, in-memory cache of swapped out
+//	pages, which sits in front of the swap area on the disk.
+//
+//	When a page is evicted, we first try to compress it into a pool
+//	of host memory.  Only if the page doesn't compress, or the pool
+//	is full, does anything go to the (slow) simulated disk.  A later
+//	page fault on the page is then satisfied from the pool without
+//	any disk I/O.
+//
+//	This is the same idea as Linux's zswap.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SWAPCACHE_H
+#define SWAPCACHE_H
+
+#include "copyright.h"
+#include "list.h"
+#include "disk.h"
+#include "machine.h"
+
+// Compressed page formats; the first byte of each compressed page
+// says which one was used.
+enum CompressedFormat {
+    SameFilled,     // the page is one 32-bit word repeated
+    LzCompressed    // LZ77-style literal runs and back references
+};
+
+// The following class defines the swap cache.  Pages are named by
+// the swap sector they would otherwise be stored in.  The cache is
+// exclusive: a page is dropped from the pool once it has been paged
+// back in, since the next eviction will store it again anyway.
+
+class SwapCache {
+  public:
+    SwapCache(int size);	// Initialize a pool of "size" bytes
+    ~SwapCache();		// De-allocate the pool
+
+    bool Reserve(int count);	// Make room for "count" pages that
+				// are about to be swapped out; TRUE
+				// if we had to wait for the disk
+    bool Store(int sector, char *data);
+				// Compress a page that is being swapped
+				// out.  Returns FALSE if the caller
+				// must write it to the disk itself.
+    bool Load(int sector, char *data);
+				// Swap in a page from the pool, if it's
+				// there; returns FALSE on a miss
+    void Invalidate(int sector);// The page's owner has gone away
+
+    void Print();		// Print the cache statistics
+
+  private:
+    int Compress(char *page, char *buffer);
+    void Decompress(char *buffer, int length, char *page);
+    void WriteBack();		// spill the oldest page to the disk
+    void Remove(int sector);
+
+    int poolSize;		// size of the pool, in bytes
+    int poolUsed;		// bytes of compressed data in the pool
+    char *pages[NumSectors];	// compressed page for each swap sector,
+				// or NULL if the page isn't cached
+    int lengths[NumSectors];	// its compressed length
+    List<int> *order;		// cached sectors, oldest first
+
+    int numStores;		// pages accepted into the pool
+    int numRejected;		// pages that didn't compress or fit
+    int numSameFilled;		// pages stored as a single word
+    int numWriteBacks;		// pages spilled to the disk when full
+    int numHits, numMisses;	// swap-ins from the pool / the disk
+    int bytesIn, bytesOut;	// uncompressed / compressed bytes stored
+};
+
+#endif // SWAPCACHE_H
@@ -23,6 +23,7 @@ UserProgKernel::UserProgKernel(int argc, char **argv)
 {
 	debugUserProg = FALSE;
 	execfileNum = 0;
+	swapCacheSize = 0;
 	for (int i = 1; i < argc; i++)
 	{
 		if (strcmp(argv[i], "-s") == 0)
@@ -39,6 +40,7 @@ UserProgKernel::UserProgKernel(int argc, char **argv)
 			cout << "Partial usage: nachos [-s]\n";
 			cout << "Partial usage: nachos [-u]" << endl;
 			cout << "Partial usage: nachos [-e] filename" << endl;
+			cout << "Partial usage: nachos [-FIFO | -LRU] [-pff] [-zswap pages] [-cluster pages] [-merge]" << endl;
 		}
 		else if (strcmp(argv[i], "-h") == 0)
 		{
@@ -60,6 +62,27 @@ UserProgKernel::UserProgKernel(int argc, char **argv)
 			// kernel->machine->swapType = SwapType::LRU;
 			swapType = SwapType::LRU;
 		}
+		else if (strcmp(argv[i], "-pff") == 0) // working-set / page-fault-frequency load control
+		{
+			AddrSpace::loadControl = TRUE;
+		}
+		else if (strcmp(argv[i], "-zswap") == 0) // compressed swap cache of the given size
+		{
+			ASSERT(i + 1 < argc);
+			swapCacheSize = atoi(argv[i + 1]);
+			i++;
+		}
+		else if (strcmp(argv[i], "-merge") == 0) // same-page merging
+		{
+			AddrSpace::pageMerging = TRUE;
+		}
+		else if (strcmp(argv[i], "-cluster") == 0) // pages per swap cluster
+		{
+			ASSERT(i + 1 < argc);
+			AddrSpace::clusterPages = atoi(argv[i + 1]);
+			ASSERT(AddrSpace::clusterPages > 0 && SectorsPerTrack % AddrSpace::clusterPages == 0);
+			i++;
+		}
 		else
 		{
 			// cout << "Unknown option: " << argv[i] << endl;
@@ -80,6 +103,9 @@ void UserProgKernel::Initialize()
 	fileSystem = new FileSystem();
 #ifdef FILESYS // 在makefile中定義了FILESYS，因此可使用SynchDisk
 	synchDisk = new SynchDisk("New SynchDisk");
+	swapCache = NULL;
+	if (swapCacheSize > 0)
+		swapCache = new SwapCache(swapCacheSize * PageSize);
 #endif // FILESYS
 }
 
@@ -94,6 +120,7 @@ UserProgKernel::~UserProgKernel()
 	delete fileSystem;
 	delete machine;
 #ifdef FILESYS
+	delete swapCache;
 	delete synchDisk;
 #endif
 }
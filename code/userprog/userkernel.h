@@ -16,6 +16,7 @@
 #include "filesys.h"
 #include "machine.h"
 #include "synchdisk.h"
+#include "swapcache.h"
 
 class SynchDisk;
 class UserProgKernel : public ThreadedKernel
@@ -37,6 +38,7 @@ public:
 
 #ifdef FILESYS
     SynchDisk *synchDisk;
+    SwapCache *swapCache; // compressed swap pages, NULL if disabled
 #endif // FILESYS
 
 private:
@@ -45,6 +47,7 @@ private:
     char *execfile[10];
     int execfileNum;
     SwapType swapType;
+    int swapCacheSize; // in pages, 0 for no swap cache
 };
 
 #endif // USERKERNEL_H